@@ -2,9 +2,9 @@
 
 #ifdef RASPBERRY_PI
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
-#include <math.h>       /* ceil */
 #include <wiringPi.h>
 
 #pragma GCC diagnostic ignored "-Wchar-subscripts"
@@ -19,20 +19,43 @@
 
 #endif // ifdef RASPBERRY_PI
 
+#ifdef HT1632_STATS
+#define STATS(stmt) stmt;
+#else // HT1632_STATS
+#define STATS(stmt)
+#endif // HT1632_STATS
+
+// State of the CS shift register before it is first cleared.
+#define CS_UNKNOWN -2
+
+// Set the DATA pin (of every chain, with PARALLEL_DATA_CHAINS) to level.
+#if PARALLEL_DATA_CHAINS > 1
+#define DATA_OUT(level) writeDataPort((level) ? _dataAllMask : 0)
+#else // PARALLEL_DATA_CHAINS > 1
+#define DATA_OUT(level) digitalWrite(_pinDATA, level)
+#endif // PARALLEL_DATA_CHAINS > 1
+
+// Each 4-bit word with its bits reversed: the order in which they are sent (least significant
+//   first), and the word seen upside down.
+static const unsigned char REVERSED_NIBBLE [16] = {
+  0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+
 /*
  * HIGH LEVEL FUNCTIONS
  * Functions that perform advanced tasks using lower-level
  * functions go here:
  */
 
-void HT1632Class::drawText(const char text [], int x, int y, const char font [], const char font_width [], char font_height, int font_glyph_step, char gutter_space) {
+void HT1632Class::drawText(const char text [], int x, int y, const char font [], const char font_width [], char font_height, int font_glyph_step, char gutter_space, char rop) {
   int curr_x = x;
   char i = 0;
   char currchar;
   
   // Check if string is within y-bounds
-  if(y + font_height < 0 || y >= COM_SIZE)
+  if(y + font_height < 0 || y >= getHeight())
     return;
+  const int width = getWidth();
   
   while(true){  
     if(text[i] == '\0')
@@ -46,16 +69,16 @@ void HT1632Class::drawText(const char text [], int x, int y, const char font [],
       continue; // Skip this character.
     }
     // Check to see if character is not too far right.
-    if(curr_x >= OUT_SIZE)
+    if(curr_x >= width)
       break; // Stop rendering - all other characters are no longer within the screen 
     
     // Check to see if character is not too far left.
     if(curr_x + font_width[currchar] + gutter_space >= 0){
-      drawImage(font, font_width[currchar], font_height, curr_x, y,  currchar*font_glyph_step);
+      drawImage(font, font_width[currchar], font_height, curr_x, y,  currchar*font_glyph_step, rop);
       
       // Draw the gutter space
       for(char j = 0; j < gutter_space; ++j)
-        drawImage(font, 1, font_height, curr_x + font_width[currchar] + j, y, 0);
+        drawImage(font, 1, font_height, curr_x + font_width[currchar] + j, y, 0, rop);
       
     }
     
@@ -86,18 +109,153 @@ int HT1632Class::getTextWidth(const char text [], const char font_width [], char
   }
 }
 
+// Horizontal span of length pixels, starting at (x, y) and extending to the right.
+void HT1632Class::drawHLine(int x, int y, int length, bool datum) {
+  if(y < 0 || y >= getHeight())
+    return;
+  int x_end = x + length;
+  if(x < 0) x = 0;
+  if(x_end > getWidth()) x_end = getWidth();
+
+  const char bit = 1 << (y % 4);
+  const char data = datum ? bit : 0;
+  for(; x < x_end; ++x)
+    writeNibble(x, y, bit, data);
+}
+
+// Vertical span of length pixels, starting at (x, y) and extending downwards.
+// Memory is column-major with 4 vertical pixels per word, so whole words are written at once.
+void HT1632Class::drawVLine(int x, int y, int length, bool datum) {
+  if(x < 0 || x >= getWidth())
+    return;
+  int y_end = y + length;
+  if(y < 0) y = 0;
+  if(y_end > getHeight()) y_end = getHeight();
+
+  while(y < y_end) {
+    const int word_end = (y | 0b11) + 1; // First row of the next word
+    char mask = 0b00001111 << (y % 4);
+    if(y_end < word_end)
+      mask &= 0b00001111 >> (word_end - y_end);
+    mask &= 0b00001111;
+    writeNibble(x, y, mask, datum ? mask : 0);
+    y = word_end;
+  }
+}
+
+// Bresenham's line algorithm. Horizontal and vertical lines use the faster span functions.
+void HT1632Class::drawLine(int x0, int y0, int x1, int y1, bool datum) {
+  if(y0 == y1) {
+    if(x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    drawHLine(x0, y0, x1 - x0 + 1, datum);
+    return;
+  }
+  if(x0 == x1) {
+    if(y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    drawVLine(x0, y0, y1 - y0 + 1, datum);
+    return;
+  }
+
+  const int dx = (x1 > x0) ? (x1 - x0) : (x0 - x1);
+  const int dy = (y1 > y0) ? (y0 - y1) : (y1 - y0); // Negative
+  const int sx = (x0 < x1) ? 1 : -1;
+  const int sy = (y0 < y1) ? 1 : -1;
+  int err = dx + dy;
+
+  while(true) {
+    setPixel(x0, y0, datum);
+    if(x0 == x1 && y0 == y1)
+      break;
+    const int e2 = 2 * err;
+    if(e2 >= dy) { err += dy; x0 += sx; }
+    if(e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+void HT1632Class::drawRect(int x, int y, int width, int height, bool datum) {
+  if(width <= 0 || height <= 0)
+    return;
+  drawHLine(x, y, width, datum);
+  drawHLine(x, y + height - 1, width, datum);
+  drawVLine(x, y, height, datum);
+  drawVLine(x + width - 1, y, height, datum);
+}
+
+void HT1632Class::fillRect(int x, int y, int width, int height, bool datum) {
+  if(height <= 0)
+    return;
+  int x_end = x + width;
+  if(x < 0) x = 0;
+  if(x_end > getWidth()) x_end = getWidth();
+  for(; x < x_end; ++x)
+    drawVLine(x, y, height, datum);
+}
+
+// Midpoint circle algorithm.
+void HT1632Class::drawCircle(int x0, int y0, int radius, bool datum) {
+  if(radius < 0)
+    return;
+  int x = radius;
+  int y = 0;
+  int err = 1 - radius;
+
+  while(x >= y) {
+    setPixel(x0 + x, y0 + y, datum);
+    setPixel(x0 - x, y0 + y, datum);
+    setPixel(x0 + x, y0 - y, datum);
+    setPixel(x0 - x, y0 - y, datum);
+    setPixel(x0 + y, y0 + x, datum);
+    setPixel(x0 - y, y0 + x, datum);
+    setPixel(x0 + y, y0 - x, datum);
+    setPixel(x0 - y, y0 - x, datum);
+    ++y;
+    if(err < 0) {
+      err += 2 * y + 1;
+    } else {
+      --x;
+      err += 2 * (y - x) + 1;
+    }
+  }
+}
+
 /*
  * MID LEVEL FUNCTIONS
  * Functions that handle internal memory, initialize the hardware
  * and perform the rendering go here:
  */
 
+// Only frees the memory: the display keeps showing what was last rendered.
+HT1632Class::~HT1632Class() {
+  endGrayscale();
+  for(int i = 0; i < MAX_BOARDS; ++i)
+    free(mem[i]);
+}
+
 #ifdef BICOLOR_MATRIX
 
+#if PARALLEL_DATA_CHAINS > 1
+void HT1632Class::begin(int pinCS, int pinWR, const int pinsDATA [], int pinCLK) {
+  _pinDATA = pinsDATA[0];
+  _dataAllMask = 0;
+  for(char k = 0; k < PARALLEL_DATA_CHAINS; ++k) {
+    _pinsDATA[k] = pinsDATA[k];
+    pinMode(_pinsDATA[k], OUTPUT);
+#ifdef RASPBERRY_PI
+    _dataMask[k] = 1 << k; // One write per pin, see writeDataPort().
+#else // ifdef RASPBERRY_PI
+    _dataMask[k] = digitalPinToBitMask(_pinsDATA[k]);
+#endif // ifdef RASPBERRY_PI
+    _dataAllMask |= _dataMask[k];
+  }
+#ifndef RASPBERRY_PI
+  _dataPort = portOutputRegister(digitalPinToPort(_pinsDATA[0]));
+#endif // ifndef RASPBERRY_PI
+#else // PARALLEL_DATA_CHAINS > 1
 void HT1632Class::begin(int pinCS, int pinWR, int pinDATA, int pinCLK) {
+  _pinDATA = pinDATA;
+#endif // PARALLEL_DATA_CHAINS > 1
   _pinForCS = pinCS;
   _pinWR = pinWR;
-  _pinDATA = pinDATA;
   _pinCLK = pinCLK;
 
   int i=0;
@@ -109,6 +267,7 @@ void HT1632Class::begin(int pinCS, int pinWR, int pinDATA, int pinCLK) {
   pinMode(_pinWR, OUTPUT);
   pinMode(_pinDATA, OUTPUT);
   pinMode(_pinCLK, OUTPUT);
+  _csSelected = CS_UNKNOWN;
   
   // Each 8-bit mem array element stores data in the 4 least significant bits,
   //   and meta-data in the 4 most significant bits. Use bitmasking to read/write
@@ -122,7 +281,7 @@ void HT1632Class::begin(int pinCS, int pinWR, int pinDATA, int pinCLK) {
 
   select(0);
 
-  // Send Master commands
+  // Send Master commands. Each select() only shifts the selection on to the next chip.
   for(i=1; i <= NUM_ACTIVE_CHIPS; ++i) {
     select(i);  // 1 based
     writeData(HT1632_ID_CMD, HT1632_ID_LEN);    // Command mode
@@ -135,8 +294,8 @@ void HT1632Class::begin(int pinCS, int pinWR, int pinDATA, int pinCLK) {
     writeCommand(HT1632_CMD_LEDON); // Turn on LED duty cycle generator
     writeCommand(HT1632_CMD_PWM(16)); // PWM 16/16 duty
     writeCommand(HT1632_CMD_BLOFF); // Blink off
-    select(0);
   }
+  select(0);
   
   for(i=0; i < MAX_BOARDS; ++i) {
     _globalNeedsRewriting[i] = false;
@@ -158,29 +317,27 @@ void HT1632Class::initialize(int pinWR, int pinDATA) {
 #else // BICOLOR_MATRIX
 
 void HT1632Class::begin(int pinCS1, int pinWR, int pinDATA) {
-  _numActivePins = 1;
-  _pinCS[0] = pinCS1;
-  initialize(pinWR, pinDATA);
+  const int pinsCS [] = {pinCS1};
+  begin(pinsCS, 1, pinWR, pinDATA);
 }
 void HT1632Class::begin(int pinCS1, int pinCS2, int pinWR,   int pinDATA) {
-  _numActivePins = 2;
-  _pinCS[0] = pinCS1;
-  _pinCS[1] = pinCS2;
-  initialize(pinWR, pinDATA);
+  const int pinsCS [] = {pinCS1, pinCS2};
+  begin(pinsCS, 2, pinWR, pinDATA);
 }
 void HT1632Class::begin(int pinCS1, int pinCS2, int pinCS3,  int pinWR,   int pinDATA) {
-  _numActivePins = 3;
-  _pinCS[0] = pinCS1;
-  _pinCS[1] = pinCS2;
-  _pinCS[2] = pinCS3;
-  initialize(pinWR, pinDATA);
+  const int pinsCS [] = {pinCS1, pinCS2, pinCS3};
+  begin(pinsCS, 3, pinWR, pinDATA);
 }
 void HT1632Class::begin(int pinCS1, int pinCS2, int pinCS3,  int pinCS4,  int pinWR,   int pinDATA) {
-  _numActivePins = 4;
-  _pinCS[0] = pinCS1;
-  _pinCS[1] = pinCS2;
-  _pinCS[2] = pinCS3;
-  _pinCS[3] = pinCS4;
+  const int pinsCS [] = {pinCS1, pinCS2, pinCS3, pinCS4};
+  begin(pinsCS, 4, pinWR, pinDATA);
+}
+void HT1632Class::begin(const int pinsCS [], int numPins, int pinWR, int pinDATA) {
+  if(numPins > MAX_CS_PINS)
+    numPins = MAX_CS_PINS;
+  _numActivePins = numPins;
+  for(int i = 0; i < numPins; ++i)
+    _pinCS[i] = pinsCS[i];
   initialize(pinWR, pinDATA);
 }
 
@@ -188,6 +345,7 @@ void HT1632Class::initialize(int pinWR, int pinDATA) {
   _pinWR = pinWR;
   _pinDATA = pinDATA;
   
+  setTiling(_numActivePins); // All boards side by side.
   for(int i=0; i<_numActivePins; ++i){
     pinMode(_pinCS[i], OUTPUT);
     // Allocate new memory for mem
@@ -198,17 +356,16 @@ void HT1632Class::initialize(int pinWR, int pinDATA) {
   pinMode(_pinWR, OUTPUT);
   pinMode(_pinDATA, OUTPUT);
   
+  _csMask = -1; // The CS pins are in an unknown state: set them all.
   select();
   
-  mem[4] = (char *)malloc(ADDR_SPACE_SIZE);
+  mem[BUFFER_SECONDARY] = (char *)malloc(ADDR_SPACE_SIZE);
   // Each 8-bit mem array element stores data in the 4 least significant bits,
   //   and meta-data in the 4 most significant bits. Use bitmasking to read/write
   //   the meta-data.
-  drawTarget(4);
+  drawTarget(BUFFER_SECONDARY);
   clear();
   // Clean out memory
-  int i=0;
-  
   
   // Send configuration to chip:
   // This configuration is from the HT1632 datasheet, with one modification:
@@ -218,7 +375,7 @@ void HT1632Class::initialize(int pinWR, int pinDATA) {
   
   // Send Master commands
   
-  select(0b1111); // Assume that board 1 is the master.
+  selectChip(ALL_CHIPS); // Assume that board 1 is the master.
   writeData(HT1632_ID_CMD, HT1632_ID_LEN);    // Command mode
   
   writeCommand(HT1632_CMD_SYSDIS); // Turn off system oscillator
@@ -270,34 +427,183 @@ void HT1632Class::initialize(int pinWR, int pinDATA) {
   drawTarget(0);
 }
 
+bool HT1632Class::setTiling(char columns, char rows, const char boards []) {
+  if(columns < 1 || rows < 1 || columns * rows > _numActivePins)
+    return false;
+  for(char t = 0; t < columns * rows; ++t)
+    if(boards && (boards[t] < 0 || boards[t] >= _numActivePins))
+      return false;
+  _tileColumns = columns;
+  _tileRows = rows;
+  for(char t = 0; t < columns * rows; ++t)
+    _tileBoard[t] = boards ? boards[t] : t;
+  return true;
+}
+
 #endif // BICOLOR_MATRIX
 
 void HT1632Class::setPixel(int loc_x, int loc_y, bool datum) {
-  if (datum) {
-    mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] | (1 << (loc_y % 4))) | MASK_NEEDS_REWRITING;
+  if(loc_x < 0 || loc_x >= getWidth() || loc_y < 0 || loc_y >= getHeight())
+    return;
+  const char bit = 1 << (loc_y % 4);
+  writeNibble(loc_x, loc_y, bit, datum ? bit : 0);
+}
+
+bool HT1632Class::getPixel(int loc_x, int loc_y) {
+  if(loc_x < 0 || loc_x >= getWidth() || loc_y < 0 || loc_y >= getHeight())
+    return false;
+  toPhysical(loc_x, loc_y, physicalWidth(), physicalHeight());
+  return (*cellAt(loc_x, loc_y, false) >> (loc_y % 4)) & 1;
+}
+
+// Combine the bits selected by mask in the 4-bit word that holds pixel (loc_x, loc_y) with the
+//   matching bits of data. Bit k of the word is row (loc_y & ~3) + k.
+// PRECONDITION: (loc_x, loc_y) is within the draw target.
+// The raster operation rop combines data with the current contents, see ROP_COPY and friends.
+void HT1632Class::writeNibble(int loc_x, int loc_y, char mask, char data, char rop) {
+  if(!_swapXY) {
+    // The word is still a word of the buffer, possibly upside down.
+    if(_flipX)
+      loc_x = physicalWidth() - 1 - loc_x;
+    if(_flipY) {
+      loc_y = physicalHeight() - 4 - (loc_y & ~3);
+      mask = REVERSED_NIBBLE[mask & 0b00001111];
+      data = REVERSED_NIBBLE[data & 0b00001111];
+    }
+    writeCell(cellAt(loc_x, loc_y), mask, data, rop);
+    return;
   }
-  else {
-    mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & ~(1 << (loc_y % 4))) | MASK_NEEDS_REWRITING;
+
+  // Rotated by 90 or 270 degrees: the 4 rows of the word are one pixel of 4 neighbouring columns.
+  const int py = _flipY ? physicalHeight() - 1 - loc_x : loc_x;
+  const char bit = 1 << (py % 4);
+  for(char k = 0; k < 4; ++k)
+    if(mask & (1 << k)) {
+      const int ly = (loc_y & ~3) + k;
+      writeCell(cellAt(_flipX ? physicalWidth() - 1 - ly : ly, py), bit, ((data >> k) & 1) ? bit : 0, rop);
+    }
+}
+
+// Combine the bits selected by mask in the buffer word at cell with the matching bits of data.
+//   The word is only flagged for rewriting if its contents actually change.
+void HT1632Class::writeCell(char * cell, char mask, char data, char rop) {
+  const char curr = *cell & 0b00001111;
+  data &= mask;
+  char next;
+  switch(rop) {
+    case ROP_OR:      next = curr | data;            break;
+    case ROP_AND:     next = curr & (data | ~mask);  break;
+    case ROP_XOR:     next = curr ^ data;            break;
+    case ROP_AND_NOT: next = curr & ~data;           break;
+    default:          next = (curr & ~mask) | data;  break; // ROP_COPY
+  }
+  if(next != curr)
+    *cell = next | MASK_NEEDS_REWRITING;
+}
+
+// The word of the current draw target that holds pixel (loc_x, loc_y). In BUFFER_TILED, each 4-bit
+//   word belongs to a single board, since COM_SIZE is a multiple of 4.
+// The word is about to be modified, so a chip still waiting in a pipelined render is sent first,
+//   unless modify is false: reading the word does not need to wait.
+// PRECONDITION: (loc_x, loc_y) is within the draw target.
+char * HT1632Class::cellAt(int loc_x, int loc_y, bool modify) {
+  char buffer = _tgtBuffer;
+#ifndef BICOLOR_MATRIX
+  if(_tgtBuffer == BUFFER_TILED) {
+    buffer = _tileBoard[(loc_y / COM_SIZE) * _tileColumns + loc_x / OUT_SIZE];
+    loc_x %= OUT_SIZE;
+    loc_y %= COM_SIZE;
   }
+#endif // BICOLOR_MATRIX
+  const int addr = GET_ADDR_FROM_X_Y(loc_x, loc_y);
+  if(modify && _pipeNext < _pipeEnd)
+    renderBarrier(buffer, addr);
+  return &mem[buffer][addr];
 }
 
 void HT1632Class::drawTarget(char targetBuffer) {
 #ifdef BICOLOR_MATRIX
   if (targetBuffer >= 0 && targetBuffer < MAX_BOARDS) _tgtBuffer = targetBuffer;
 #else // BICOLOR_MATRIX
-  if(targetBuffer == 0x04 || (targetBuffer >= 0 && targetBuffer < _numActivePins))  
+  if(targetBuffer == BUFFER_SECONDARY || targetBuffer == BUFFER_TILED || (targetBuffer >= 0 && targetBuffer < _numActivePins))  
     _tgtBuffer = targetBuffer;
 #endif // BICOLOR_MATRIX
 }
 
-void HT1632Class::drawImage(const char * img, char width, char height, int x, int y, int offset){
+// Size of the current draw target, as laid out in the buffers.
+int HT1632Class::physicalWidth() {
+#ifndef BICOLOR_MATRIX
+  if(_tgtBuffer == BUFFER_TILED)
+    return _tileColumns * OUT_SIZE;
+#endif // BICOLOR_MATRIX
+  return OUT_SIZE;
+}
+
+int HT1632Class::physicalHeight() {
+#ifndef BICOLOR_MATRIX
+  if(_tgtBuffer == BUFFER_TILED)
+    return _tileRows * COM_SIZE;
+#endif // BICOLOR_MATRIX
+  return COM_SIZE;
+}
+
+int HT1632Class::getWidth() {
+  return _swapXY ? physicalHeight() : physicalWidth();
+}
+
+int HT1632Class::getHeight() {
+  return _swapXY ? physicalWidth() : physicalHeight();
+}
+
+// The orientation is a rotation, ROTATE_0 to ROTATE_270, optionally combined with MIRROR_X and/or
+//   MIRROR_Y. It is kept as a transposition followed by flips of the buffer axes.
+void HT1632Class::setOrientation(char orientation) {
+  const char rotation = orientation & 0b0011;
+  _orientation = orientation;
+  _swapXY = rotation == ROTATE_90 || rotation == ROTATE_270;
+  _flipX = rotation == ROTATE_90 || rotation == ROTATE_180;
+  _flipY = rotation == ROTATE_180 || rotation == ROTATE_270;
+  // Mirrors apply to the drawing coordinates, before the rotation.
+  if(orientation & (_swapXY ? MIRROR_Y : MIRROR_X))
+    _flipX = !_flipX;
+  if(orientation & (_swapXY ? MIRROR_X : MIRROR_Y))
+    _flipY = !_flipY;
+}
+
+char HT1632Class::getOrientation() {
+  return _orientation;
+}
+
+// Convert (loc_x, loc_y) to the coordinates of the same pixel in a buffer of width x height.
+void HT1632Class::toPhysical(int & loc_x, int & loc_y, int width, int height) {
+  if(_swapXY) {
+    const int tmp = loc_x;
+    loc_x = loc_y;
+    loc_y = tmp;
+  }
+  if(_flipX)
+    loc_x = width - 1 - loc_x;
+  if(_flipY)
+    loc_y = height - 1 - loc_y;
+}
+
+void HT1632Class::drawImage(const char * img, char width, char height, int x, int y, int offset, char rop){
   char mask;
   
   // Sanity checks
-  if(y + height < 0 || x + width < 0 || y > COM_SIZE || x > OUT_SIZE)
+  const int tgt_width = getWidth();
+  const int tgt_height = getHeight();
+  if(y + height < 0 || x + width < 0 || y > tgt_height || x > tgt_width)
     return;
   // After looking at the rest of this function, you may need one.
   
+  if(_swapXY) {
+    drawImageTransposed(img, width, height, x, y, offset, rop);
+    return;
+  }
+  
+  const int rows = (height + 3) / 4; // Number of 4-bit words per column of img.
+  
   // Copying Engine.
   // You are only expected to understand this if it does not work right. ;)
   for(char i=0; i<width; ++i) {
@@ -305,12 +611,13 @@ void HT1632Class::drawImage(const char * img, char width, char height, int x, in
     char carryover_num = (y - (y & ~ 3)); // Number of digits carried over
     bool carryover_valid = false; // If true, there is data to be carried over.
     
-    char loc_x = i + x;
-    if(loc_x < 0 || loc_x >= OUT_SIZE) // Skip this column if it is out of range.
+    int loc_x = i + x;
+    if(loc_x < 0 || loc_x >= tgt_width) // Skip this column if it is out of range.
       continue;
+    const char * column = &img[rows*i + offset];
     for(char j=0; j < (carryover_valid ? (height+4):height) ; j+=4) {
-      char loc_y = j + y;
-      if(loc_y <= -4 || loc_y >= COM_SIZE) // Skip this row if it is out of range.
+      int loc_y = j + y;
+      if(loc_y <= -4 || loc_y >= tgt_height) // Skip this row if it is out of range.
         continue;
       // Direct copying possible when render is on boundaries.
       // The bit manipulation here is designed to copy from img only the relevant sections.
@@ -319,15 +626,18 @@ void HT1632Class::drawImage(const char * img, char width, char height, int x, in
      
       //if(j<height)
       //  mask = (height-loc_y >= 4)?0b00001111:(0b00001111 >> (4-(height-j))) & 0b00001111; // Mask bottom
-        
-      if(loc_y % 4 == 0) {
-	  const int shiftBottom = 4-(height-j);
-	  mask = (height-loc_y >= 4 || shiftBottom <= 0) ? 0b00001111 : (0b00001111 >> shiftBottom) & 0b00001111; // Mask bottom
+      
+      // The current 4-bit word of img. There is none when writing one line past the end.
 #ifdef RASPBERRY_PI
-          mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & (~mask) & 0b00001111) | (img[(int)ceil((float)height/4.0f)*i + j/4 + offset] & mask) | MASK_NEEDS_REWRITING;
+      const char src = (j < height) ? column[j/4] : 0;
 #else // ifdef RASPBERRY_PI 
-          mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & (~mask) & 0b00001111) | (pgm_read_byte(&img[(int)ceil((float)height/4.0f)*i + j/4 + offset]) & mask) | MASK_NEEDS_REWRITING;
+      const char src = (j < height) ? pgm_read_byte(&column[j/4]) : 0;
 #endif // ifdef RASPBERRY_PI 
+        
+      if(loc_y % 4 == 0) {
+	  const int shiftBottom = 4-(height-j);
+	  mask = (shiftBottom <= 0) ? 0b00001111 : (0b00001111 >> shiftBottom) & 0b00001111; // Mask bottom
+          writeNibble(loc_x, loc_y, mask, src, rop);
       } else {
         // If carryover_valid is NOT true, then this is the first set to be copied.
         //   If loc_y > 0, preserve the contents of the pixels above, copy to mem, and then copy remaining
@@ -336,134 +646,407 @@ void HT1632Class::drawImage(const char * img, char width, char height, int x, in
         // COPY START
         if(!carryover_valid) { 
           if(loc_y > 0) {
-	    const int shiftBottom = 4-(height-j);
-	    mask = (height-loc_y >= 4 || shiftBottom <= 0) ? 0b00001111 : (0b00001111 >> shiftBottom) & 0b00001111; // Mask bottom
+	    const int shiftBottom = 4-(height+carryover_num-j);
+	    mask = (shiftBottom <= 0) ? 0b00001111 : (0b00001111 >> shiftBottom) & 0b00001111; // Mask bottom
             mask = (0b00001111 << carryover_num) & mask; // Mask top
-#ifdef RASPBERRY_PI 
-            mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & (~mask) & 0b00001111) | ((img[(int)ceil((float)height/4.0f)*i + j/4 + offset] << carryover_num) & mask) | MASK_NEEDS_REWRITING;
-#else  // ifdef RASPBERRY_PI 
-            mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & (~mask) & 0b00001111) | ((pgm_read_byte(&img[(int)ceil((float)height/4.0f)*i + j/4 + offset]) << carryover_num) & mask) | MASK_NEEDS_REWRITING;
-#endif  // ifdef RASPBERRY_PI 
+            writeNibble(loc_x, loc_y, mask, src << carryover_num, rop);
           }
           carryover_valid = true;
         } else {
           // COPY END
           if(j >= height) {
             // Its writing one line past the end.
-            // Use this line to get rid of the final carry-over.
-            mask = (0b00001111 >> (4 - carryover_num)) & 0b00001111; // Mask bottom
-            mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & (~mask) & 0b00001111) | (carryover_y >> (4 - carryover_num) & mask) | MASK_NEEDS_REWRITING;
+            // Use this line to get rid of the final carry-over, which only holds the rows of img
+            //   that are left, if any.
+            const int carried = height + carryover_num - j;
+            if(carried <= 0)
+              continue;
+            mask = (0b00001111 >> (4 - ((carried < carryover_num) ? carried : carryover_num))) & 0b00001111; // Mask bottom
+            writeNibble(loc_x, loc_y, mask, (carryover_y >> (4 - carryover_num)) & mask, rop);
           // COPY MIDDLE  
           } else {
             // There is data in the carry-over buffer. Copy that data and the values from the current cell into mem.
             // The inclusion of a carryover_num term is to account for the presence of the carryover data  when calculating the bottom clipping.
 	    const int shiftBottom = 4-(height+carryover_num-j);
-	    mask = (height-loc_y >= 4 || shiftBottom <= 0) ? 0b00001111 : (0b00001111 >> shiftBottom) & 0b00001111; // Mask bottom
-#ifdef RASPBERRY_PI 
-            mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & (~mask) & 0b00001111) | ((img[(int)ceil((float)height/4.0f)*i + j/4 + offset] << carryover_num) & mask) | (carryover_y >> (4 - carryover_num) & mask) | MASK_NEEDS_REWRITING;
-#else // ifdef RASPBERRY_PI 
-            mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] = (mem[_tgtBuffer][GET_ADDR_FROM_X_Y(loc_x,loc_y)] & (~mask) & 0b00001111) | ((pgm_read_byte(&img[(int)ceil((float)height/4.0f)*i + j/4 + offset]) << carryover_num) & mask) | (carryover_y >> (4 - carryover_num) & mask) | MASK_NEEDS_REWRITING;
-#endif // ifdef RASPBERRY_PI 
+	    mask = (shiftBottom <= 0) ? 0b00001111 : (0b00001111 >> shiftBottom) & 0b00001111; // Mask bottom
+            writeNibble(loc_x, loc_y, mask, (src << carryover_num) | (carryover_y >> (4 - carryover_num)), rop);
           }
         }
-#ifdef RASPBERRY_PI
-        carryover_y = img[(int)ceil((float)height/4.0f)*i + j/4 + offset];
-#else // ifdef RASPBERRY_PI 
-        carryover_y = pgm_read_byte(&img[(int)ceil((float)height/4.0f)*i + j/4 + offset]);
-#endif // ifdef RASPBERRY_PI 
+        carryover_y = src;
       }
     }
   }
 }
 
+// drawImage() for ROTATE_90 and ROTATE_270, where the columns of the image are rows of the
+//   buffer: each row of the image is gathered into whole buffer words, 4 pixels at a time.
+void HT1632Class::drawImageTransposed(const char * img, char width, char height, int x, int y, int offset, char rop) {
+  const int rows = (height + 3) / 4; // Number of 4-bit words per column of img.
+  const int tgt_width = getWidth();
+  const int tgt_height = getHeight();
+
+  for(char j = 0; j < height; ++j) {
+    const int loc_y = y + j;
+    if(loc_y < 0 || loc_y >= tgt_height)
+      continue;
+    const int px = _flipX ? physicalWidth() - 1 - loc_y : loc_y;
+    const char src_bit = 1 << (j % 4);
+    int word = -1;      // First buffer row of the word being gathered
+    char mask = 0;
+    char data = 0;
+    for(char i = 0; i < width; ++i) {
+      const int loc_x = x + i;
+      if(loc_x < 0 || loc_x >= tgt_width)
+        continue;
+      const int py = _flipY ? physicalHeight() - 1 - loc_x : loc_x;
+      if((py & ~3) != word) {
+        if(mask)
+          writeCell(cellAt(px, word), mask, data, rop);
+        word = py & ~3;
+        mask = 0;
+        data = 0;
+      }
+#ifdef RASPBERRY_PI
+      const char src = img[rows*i + offset + j/4];
+#else // ifdef RASPBERRY_PI
+      const char src = pgm_read_byte(&img[rows*i + offset + j/4]);
+#endif // ifdef RASPBERRY_PI
+      mask |= 1 << (py % 4);
+      if(src & src_bit)
+        data |= 1 << (py % 4);
+    }
+    if(mask)
+      writeCell(cellAt(px, word), mask, data, rop);
+  }
+}
+
 void HT1632Class::clear(){
+#ifndef BICOLOR_MATRIX
+  if(_tgtBuffer == BUFFER_TILED) {
+    for(char t = 0; t < _tileColumns * _tileRows; ++t) {
+      _tgtBuffer = _tileBoard[t];
+      clear();
+    }
+    _tgtBuffer = BUFFER_TILED;
+    return;
+  }
+#endif // BICOLOR_MATRIX
+  if(_pipeNext < _pipeEnd)
+    renderBarrier(_tgtBuffer, ADDR_SPACE_SIZE - 1); // Every chip is about to change.
   // Note: Must use int below, because in BICOLOR screens, addr space is greater than 255
   for(int i=0; i < ADDR_SPACE_SIZE; ++i) mem[_tgtBuffer][i] = 0x00 | MASK_NEEDS_REWRITING; // Needs to be redrawn 
 }
 
+// Copy a rectangle of sourceBuffer to the same place in the current target buffer.
+// All buffers share the same layout, so this is done 4 vertical pixels at a time.
+// BUFFER_TILED can be neither the source nor the target.
+void HT1632Class::copyRegion(char sourceBuffer, int x, int y, int width, int height) {
+  if(sourceBuffer < 0 || sourceBuffer >= MAX_BOARDS || mem[sourceBuffer] == NULL || sourceBuffer == _tgtBuffer
+      || _tgtBuffer >= MAX_BOARDS)
+    return;
+  int x_end = x + width;
+  int y_end = y + height;
+  if(x < 0) x = 0;
+  if(y < 0) y = 0;
+  if(x_end > getWidth()) x_end = getWidth();
+  if(y_end > getHeight()) y_end = getHeight();
+  if(x >= x_end || y >= y_end)
+    return;
+
+  // The rectangle is still a rectangle in the buffers, whatever the orientation.
+  int x_last = x_end - 1;
+  int y_last = y_end - 1;
+  toPhysical(x, y, OUT_SIZE, COM_SIZE);
+  toPhysical(x_last, y_last, OUT_SIZE, COM_SIZE);
+  x_end = ((x > x_last) ? x : x_last) + 1;
+  y_end = ((y > y_last) ? y : y_last) + 1;
+  if(x_last < x) x = x_last;
+  if(y_last < y) y = y_last;
+
+  for(; x < x_end; ++x) {
+    for(int loc_y = y; loc_y < y_end; ) {
+      const int word_end = (loc_y | 0b11) + 1; // First row of the next word
+      char mask = 0b00001111 << (loc_y % 4);
+      if(y_end < word_end)
+        mask &= 0b00001111 >> (word_end - y_end);
+      const int addr = GET_ADDR_FROM_X_Y(x, loc_y);
+      if(_pipeNext < _pipeEnd)
+        renderBarrier(_tgtBuffer, addr);
+      writeCell(&mem[_tgtBuffer][addr], mask & 0b00001111, mem[sourceBuffer][addr]);
+      loc_y = word_end;
+    }
+  }
+}
+
 // Draw the contents of map to screen, for memory addresses that have the needsRedrawing flag
 void HT1632Class::render() {
+  renderBegin();
+  renderFinish();
+}
+
+// Pipelined rendering: render() is renderBegin() followed by renderFinish(). Between the two, each
+//   call to renderStep() sends one chip (one board without BICOLOR_MATRIX), in increasing order, so
+//   the sketch can draw the next frame while the current one is still being sent. Drawing into a
+//   chip that has not been sent yet sends it first (with the chips before it), so every chip always
+//   shows a whole frame.
+void HT1632Class::renderBegin() {
+  renderFinish(); // Only one render at a time.
 #ifdef BICOLOR_MATRIX
   if(_tgtBuffer >= BUFFER_SECONDARY || _tgtBuffer < 0) return;
+  STATS(_renderStart = micros())
+  STATS(statsRenderStarted(_tgtBuffer))
   
-  // char selectionmask = _tgtBuffer + 1;
-  char nChip;
-  char nChipOpen = -1;                   // Automatically compact sequential writes.
-  char chipBasedAddress;
-  const int colorOffset = _tgtBuffer * 32;      // Color (aka board) memory offset in chip 
+  if(_powerSaving)
+    for(int chip = 0; chip < NUM_ACTIVE_CHIPS; ++chip)
+      updateChipPower(chip);
+  _pipeEnd = NUM_ACTIVE_CHIPS;
+#else // BICOLOR_MATRIX
+  if(_tgtBuffer == BUFFER_TILED)
+    _pipeEnd = _tileColumns * _tileRows;
+  else if(_tgtBuffer >= 0 && _tgtBuffer < _numActivePins)
+    _pipeEnd = 1;
+  else
+    return;
+#endif // BICOLOR_MATRIX
+  _pipeTarget = _tgtBuffer;
+  _pipeNext = 0;
+}
+
+// Send the next chip of the render started by renderBegin(). Returns false once every chip is sent.
+bool HT1632Class::renderStep() {
+  if(_pipeNext >= _pipeEnd)
+    return false;
+#ifdef BICOLOR_MATRIX
+  renderChip(_pipeNext++);
+  if(_pipeNext < _pipeEnd)
+    return true;
+  select(0);
   
-  for(int i=0; i < ADDR_SPACE_SIZE; ++i) {
-    if (_globalNeedsRewriting[_tgtBuffer] || 
-	(mem[_tgtBuffer][i] & MASK_NEEDS_REWRITING)) {  // Does this memory chunk need to be written to?
-      nChip = (i / 32) + 1;  // calculate nChip we will need to talk to (1 based!)
-      if ( nChipOpen != nChip ) {                      // If necessary, open the writing session by:
-	chipBasedAddress = i % 32;
-        select(nChip);       //   Selecting the chip
-        writeData(HT1632_ID_WR, HT1632_ID_LEN);
-        writeData(chipBasedAddress + colorOffset, HT1632_ADDR_LEN);   //   Selecting the memory address
-        nChipOpen = nChip;
-      }
-      writeDataRev(mem[_tgtBuffer][i], HT1632_WORD_LEN); // Write the data in reverse.
-    } else {                               // If a previous sequential write session is open, close it.
-      if (nChipOpen != -1) { select(0); nChipOpen = -1; }
+  for(char b = _pipeTarget % NUM_COLORS; b < BUFFER_SECONDARY; b += NUM_COLORS)
+    _globalNeedsRewriting[b] = false;
+  STATS(statsRenderDone(_renderStart))
+#else // BICOLOR_MATRIX
+  const int tile = _pipeNext++;
+  renderBoard(_pipeTarget == BUFFER_TILED ? _tileBoard[tile] : _pipeTarget);
+  if(_pipeNext < _pipeEnd)
+    return true;
+#endif // BICOLOR_MATRIX
+  _pipeNext = _pipeEnd = 0;
+  return false;
+}
+
+void HT1632Class::renderFinish() {
+  while(renderStep());
+}
+
+// Called before a word of buffer is modified. If a render is in progress and the word belongs to a
+//   chip that is not sent yet, the render is carried on up to that chip, so that the chip does not
+//   show part of the next frame.
+void HT1632Class::renderBarrier(char buffer, int addr) {
+#ifdef BICOLOR_MATRIX
+  if(buffer >= BUFFER_SECONDARY || buffer % NUM_COLORS != _pipeTarget % NUM_COLORS)
+    return;
+  while(_pipeNext <= addr / 32 && renderStep());
+#else // BICOLOR_MATRIX
+  if(_pipeTarget != BUFFER_TILED) {
+    if(buffer == _pipeTarget)
+      renderFinish();
+    return;
+  }
+  for(int tile = _pipeNext; tile < _pipeEnd; ++tile)
+    if(_tileBoard[tile] == buffer) {
+      while(_pipeNext <= tile && renderStep());
+      return;
+    }
+#endif // BICOLOR_MATRIX
+}
+
+#ifdef BICOLOR_MATRIX
+
+// Send the words of chip (0 based) that need to be written, in the color of the buffer being rendered.
+//   A chip gets at most one session, from its first to its last word that needs writing: the clean
+//   words in between are written again with the same data. Ending a session means deselecting the
+//   chip, and with the CS shift register the only way back to it is a new walk from chip 1, so
+//   reopening costs up to NUM_ACTIVE_CHIPS + 1 CLK pulses where the gap costs at most 30 words.
+//   The chip stays selected: if the next chip has something to write, select() only has to shift the
+//   selection forward. Chips are sent in increasing order, so a render costs at most one walk of the
+//   CS shift register.
+void HT1632Class::renderChip(int chip) {
+  const char color = _pipeTarget % NUM_COLORS;  // With PARALLEL_DATA_CHAINS, _pipeTarget may be any chain
+  const int colorOffset = color * 32;           // Color (aka board) memory offset in chip 
+  int first = -1, last = -1;
+  
+  for(int i = chip * 32; i < (chip + 1) * 32; ++i) {
+    // Every chain shares the chip selection, so a word is written if it changed in any chain.
+    bool needsRewriting = false;
+    for(char b = color; b < BUFFER_SECONDARY; b += NUM_COLORS)
+      needsRewriting |= _globalNeedsRewriting[b] || (mem[b][i] & MASK_NEEDS_REWRITING);
+
+    if (_chipAsleep[chip]) {
+      // Sleeping chips are skipped; they are rewritten entirely when they wake up.
+      mem[_pipeTarget][i] &= ~MASK_NEEDS_REWRITING;
+    } else if (needsRewriting) {  // Does this memory chunk need to be written to?
+      if (first == -1)
+        first = i;
+      last = i;
     }
   }
-  if (nChipOpen != -1) { // Close the stream at the end
-    select(0);
-    // nChipOpen = -1;
+  if (first == -1)
+    return;
+  
+  select(chip + 1);    // Selecting the chip (1 based!)
+  STATS(++_stats.sessions)
+  sessionBegin(first % 32 + colorOffset);  // Selecting the memory address
+#if PARALLEL_DATA_CHAINS > 1
+  sessionEnd();        // The words differ between chains, see writeDataRevParallel().
+#endif // PARALLEL_DATA_CHAINS > 1
+  for(int i = first; i <= last; ++i) {
+#if PARALLEL_DATA_CHAINS > 1
+    writeDataRevParallel(i, color);                    // Write every chain at once.
+#else // PARALLEL_DATA_CHAINS > 1
+    sessionWord(mem[_pipeTarget][i]);                  // Queue the data, in reverse.
+#endif // PARALLEL_DATA_CHAINS > 1
+    for(char b = color; b < BUFFER_SECONDARY; b += NUM_COLORS)
+      mem[b][i] &= ~MASK_NEEDS_REWRITING;              // This chunk is now up to date.
   }
+  sessionEnd();        // Close the stream
+}
 
 #else // BICOLOR_MATRIX
 
-  if(_tgtBuffer >= _numActivePins || _tgtBuffer < 0)
-    return;
+// Send the words of board that need to be written.
+void HT1632Class::renderBoard(char board) {
+  STATS(const unsigned long statsStart = micros())
+  STATS(statsRenderStarted(board))
+  
+  const long selectionmask = 1L << board;
   
-  char selectionmask = 0b0001 << _tgtBuffer;
+  if(_powerSaving)
+    updateChipPower(board);
+  if(_chipAsleep[board]) {
+    // Sleeping chips are skipped; they are rewritten entirely when they wake up.
+    for(int i=0; i<ADDR_SPACE_SIZE; ++i)
+      mem[board][i] &= ~MASK_NEEDS_REWRITING;
+    _globalNeedsRewriting[board] = false;
+    STATS(statsRenderDone(statsStart))
+    return;
+  }
   
   bool isOpen = false;                   // Automatically compact sequential writes.
   for(int i=0; i<ADDR_SPACE_SIZE; ++i)
-    if(_globalNeedsRewriting[_tgtBuffer] || (mem[_tgtBuffer][i] & MASK_NEEDS_REWRITING)) {  // Does this memory chunk need to be written to?
+    if(_globalNeedsRewriting[board] || (mem[board][i] & MASK_NEEDS_REWRITING)) {  // Does this memory chunk need to be written to?
       if(!isOpen) {                      // If necessary, open the writing session by:
         select(selectionmask);           //   Selecting the chip
-        writeData(HT1632_ID_WR, HT1632_ID_LEN);
-        writeData(i, HT1632_ADDR_LEN);   //   Selecting the memory address
+        STATS(++_stats.sessions)
+        sessionBegin(i);                 //   Selecting the memory address
         isOpen = true;
       }
-      writeDataRev(mem[_tgtBuffer][i], HT1632_WORD_LEN); // Write the data in reverse.
+      sessionWord(mem[board][i]);        // Queue the data, in reverse.
+      mem[board][i] &= ~MASK_NEEDS_REWRITING;           // This chunk is now up to date.
     } else                               // If a previous sequential write session is open, close it.
       if(isOpen) {
+        sessionEnd();
         select();
         isOpen = false;
       }
 
   if(isOpen) {                           // Close the stream at the end
+    sessionEnd();
     select();
     isOpen = false;
   }
 
+  _globalNeedsRewriting[board] = false;
+  STATS(statsRenderDone(statsStart))
+}
+
+#endif // BICOLOR_MATRIX
+
+// Automatic power gating. When enabled, render() puts the chips whose part of the display is blank
+//   (in every color) to sleep, and wakes them up as soon as they have something to show.
+void HT1632Class::setPowerSaving(bool enabled) {
+#if PARALLEL_DATA_CHAINS > 1
+  // Not supported: a chip can only sleep if it is blank in every chain.
+#else // PARALLEL_DATA_CHAINS > 1
+  renderFinish();
+  _powerSaving = enabled;
+  if(enabled)
+    return;
+  for(int chip = 0; chip < MAX_CHIPS; ++chip) {
+    if(_chipAsleep[chip]) {
+      setPower(true, chip);
+      _chipAsleep[chip] = false;
+      rewriteChip(chip);
+    }
+  }
+#endif // PARALLEL_DATA_CHAINS > 1
+}
+
+// Words of the memory of chip (0 based) in the given color.
+char * HT1632Class::chipWords(char color, int chip) {
+#ifdef BICOLOR_MATRIX
+  return &mem[color][chip * 32];
+#else // BICOLOR_MATRIX
+  return mem[chip];
 #endif // BICOLOR_MATRIX
+}
+
+void HT1632Class::updateChipPower(int chip) {
+  bool blank = true;
+  for(char color = 0; color < NUM_COLORS && blank; ++color) {
+    const char * words = chipWords(color, chip);
+    for(int k = 0; k < CHIP_WORDS; ++k) {
+      if(words[k] & 0b00001111) {
+        blank = false;
+        break;
+      }
+    }
+  }
 
-  _globalNeedsRewriting[_tgtBuffer] = false;
+  if(blank && !_chipAsleep[chip]) {
+    setPower(false, chip);
+    _chipAsleep[chip] = true;
+  } else if(!blank && _chipAsleep[chip]) {
+    setPower(true, chip);
+    _chipAsleep[chip] = false;
+    rewriteChip(chip);
+  }
+}
+
+// Write the whole memory of a chip, in every color, in a single session.
+void HT1632Class::rewriteChip(int chip) {
+  selectChip(chip);
+  STATS(++_stats.sessions)
+  writeData(HT1632_ID_WR, HT1632_ID_LEN);
+  writeData(0, HT1632_ADDR_LEN);
+  for(char color = 0; color < NUM_COLORS; ++color) {
+    char * words = chipWords(color, chip);
+    for(int k = 0; k < CHIP_WORDS; ++k) {
+      writeDataRev(words[k], HT1632_WORD_LEN);
+      words[k] &= ~MASK_NEEDS_REWRITING;
+    }
+  }
+  select();
 }
 
 // Set the brightness to an integer level between 1 and 16 (inclusive).
 // Uses the PWM feature to set the brightness.
-void HT1632Class::setBrightness(char brightness, char selectionmask) {
+void HT1632Class::setBrightness(char brightness, long selectionmask) {
 #ifdef BICOLOR_MATRIX
   // NOTE: selectionmask is not really useful in BICOLOR boards, because
   //       it is not granular enough to the end user. Same applies to blink.
   //       So we just did not bother with it in here...
-  for(int i=1; i <= NUM_ACTIVE_CHIPS; ++i) {
-    select(i);  // 1 based!
-    writeData(HT1632_ID_CMD, HT1632_ID_LEN);    // Command mode
-    writeCommand(HT1632_CMD_PWM(brightness));   // Set brightness
-  }
-  select(0);
+  // All chips are selected at once, so this costs a single walk of the CS shift register.
+  queueCommand(HT1632_CMD_PWM(brightness));   // Set brightness
+  flushCommands();
 #else // BICOLOR_MATRIX
-  if(selectionmask == 0b00010000) {
+  if(selectionmask == 0) {
     if(_tgtBuffer < _numActivePins)
-      selectionmask = 0b0001 << _tgtBuffer;
-    else
+      selectionmask = 1L << _tgtBuffer;
+    else if(_tgtBuffer == BUFFER_TILED) {
+      for(char t = 0; t < _tileColumns * _tileRows; ++t)
+        selectionmask |= 1L << _tileBoard[t];
+    } else
       return;
   }
   
@@ -474,6 +1057,182 @@ void HT1632Class::setBrightness(char brightness, char selectionmask) {
 #endif // BICOLOR_MATRIX
 }
 
+// Send a command to every chip right away.
+void HT1632Class::sendCommand(char command) {
+  queueCommand(command);
+  flushCommands();
+}
+
+// Turn the hardware blinking of the LEDs (about 1Hz) on or off.
+void HT1632Class::setBlink(bool blink, int chip) {
+  queueCommand(blink ? HT1632_CMD_BLON : HT1632_CMD_BLOFF, chip);
+  flushCommands();
+}
+
+// Power saving: turning a chip off stops its oscillator and LED driver. The contents of its
+//   memory are kept, and are shown again when it is turned back on.
+void HT1632Class::setPower(bool on, int chip) {
+  if(on) {
+    queueCommand(HT1632_CMD_SYSEN, chip);  // Turn on system oscillator
+    queueCommand(HT1632_CMD_LEDON, chip);  // Turn on LED duty cycle generator
+  } else {
+    queueCommand(HT1632_CMD_LEDOFF, chip);
+    queueCommand(HT1632_CMD_SYSDIS, chip);
+  }
+  flushCommands();
+}
+
+// Queue a command for a chip (0 based), or for all chips. Commands are only sent by flushCommands(),
+//   or when the queue is full.
+void HT1632Class::queueCommand(char command, int chip) {
+  if(_numQueuedCommands >= COMMAND_QUEUE_SIZE)
+    flushCommands();
+  _cmdQueue[_numQueuedCommands] = command;
+  _cmdChip[_numQueuedCommands] = chip;
+  ++_numQueuedCommands;
+}
+
+// Send all queued commands, opening as few command sessions as possible:
+//   - Consecutive commands for all chips are sent in a single session, with all chips selected.
+//   - Between those, the commands of each chip are sent together, in a single session per chip,
+//     visiting the chips in increasing order. The order of the commands of one chip is kept.
+void HT1632Class::flushCommands() {
+  char start = 0;
+  while(start < _numQueuedCommands) {
+    char end = start;
+    if(_cmdChip[start] == ALL_CHIPS) {
+      while(end < _numQueuedCommands && _cmdChip[end] == ALL_CHIPS)
+        ++end;
+      openCommandSession(ALL_CHIPS);
+      for(char k = start; k < end; ++k)
+        writeCommand(_cmdQueue[k]);
+      closeCommandSession();
+    } else {
+      while(end < _numQueuedCommands && _cmdChip[end] != ALL_CHIPS)
+        ++end;
+      // Send the commands of the chips in [start, end), lowest chip first.
+      int prevChip = -1;
+      while(true) {
+        int chip = -1;
+        for(char k = start; k < end; ++k)
+          if(_cmdChip[k] > prevChip && (chip == -1 || _cmdChip[k] < chip))
+            chip = _cmdChip[k];
+        if(chip == -1)
+          break;
+        // Opening the session of the next chip ends the previous one, see select().
+        openCommandSession(chip);
+        for(char k = start; k < end; ++k)
+          if(_cmdChip[k] == chip)
+            writeCommand(_cmdQueue[k]);
+        prevChip = chip;
+      }
+      closeCommandSession();
+    }
+    start = end;
+  }
+  _numQueuedCommands = 0;
+}
+
+void HT1632Class::openCommandSession(int chip) {
+  selectChip(chip);
+  writeData(HT1632_ID_CMD, HT1632_ID_LEN);    // Command mode
+}
+
+void HT1632Class::closeCommandSession() {
+  select();
+}
+
+// Enable reading back the memory of the chips. This needs the RD pin of the chips to be wired to
+//   pinRD, and the DATA pin to be bidirectional (DATA is switched to INPUT while reading).
+void HT1632Class::setReadPin(int pinRD) {
+#if PARALLEL_DATA_CHAINS > 1
+  // Not supported: the chains do not share a DATA pin to read from, so scrub() stays disabled.
+#else // PARALLEL_DATA_CHAINS > 1
+  _pinRD = pinRD;
+  _canRead = true;
+  pinMode(_pinRD, OUTPUT);
+  digitalWrite(_pinRD, HIGH);
+  _scrubChip = 0;
+#endif // PARALLEL_DATA_CHAINS > 1
+}
+
+// Check the memory of one chip against the render buffers, and rewrite the words that differ.
+//   Each call checks the next chip, so calling this periodically keeps every chip healthy (for
+//   example after an ESD event or a power glitch) at the cost of one chip read per call.
+//   Words that are waiting to be rendered are not checked. Returns true if a chip was repaired.
+bool HT1632Class::scrub() {
+  if(!_canRead)
+    return false;
+  renderFinish(); // The buffers must match what the chips were sent.
+
+  bool repaired = false;
+#ifdef BICOLOR_MATRIX
+  const int chip = _scrubChip;
+  _scrubChip = (_scrubChip + 1) % NUM_ACTIVE_CHIPS;
+
+  for(char color = 0; color < NUM_COLORS && !_chipAsleep[chip]; ++color) {
+    if(_globalNeedsRewriting[color])
+      continue;
+    repaired |= scrubWords(chip + 1, color * 32, &mem[color][chip * 32], 32);
+  }
+#else // BICOLOR_MATRIX
+  const char board = _scrubChip;
+  _scrubChip = (_scrubChip + 1) % _numActivePins;
+
+  if(!_globalNeedsRewriting[board] && !_chipAsleep[board])
+    repaired = scrubWords(1L << board, 0, mem[board], ADDR_SPACE_SIZE);
+#endif // BICOLOR_MATRIX
+  return repaired;
+}
+
+// Read count words from the chip selected by selectionmask, starting at chip address addr, and
+//   compare them with buffer. The words that differ are rewritten from buffer.
+bool HT1632Class::scrubWords(long selectionmask, char addr, char * buffer, int count) {
+  char differs [(CHIP_WORDS + 7) / 8];
+  bool repaired = false;
+
+  select(selectionmask);
+  writeData(HT1632_ID_RD, HT1632_ID_LEN);
+  writeData(addr, HT1632_ADDR_LEN);
+  pinMode(_pinDATA, INPUT);
+  for(int i = 0; i < count; ++i) {
+    const char word = readDataRev(HT1632_WORD_LEN);
+    const bool bad = !(buffer[i] & MASK_NEEDS_REWRITING) && word != (buffer[i] & 0b00001111);
+    if(i % 8 == 0)
+      differs[i / 8] = 0;
+    if(bad) {
+      differs[i / 8] |= 1 << (i % 8);
+      repaired = true;
+    }
+  }
+  pinMode(_pinDATA, OUTPUT);
+  select();
+
+  if(!repaired)
+    return false;
+
+  // Rewrite the damaged words, compacting sequential writes.
+  bool isOpen = false;
+  for(int i = 0; i < count; ++i) {
+    if(differs[i / 8] & (1 << (i % 8))) {
+      if(!isOpen) {
+        select(selectionmask);
+        STATS(++_stats.sessions)
+        writeData(HT1632_ID_WR, HT1632_ID_LEN);
+        writeData(addr + i, HT1632_ADDR_LEN);
+        isOpen = true;
+      }
+      writeDataRev(buffer[i], HT1632_WORD_LEN);
+    } else if(isOpen) {
+      select();
+      isOpen = false;
+    }
+  }
+  if(isOpen)
+    select();
+  return true;
+}
+
 void HT1632Class::transition(char mode, int time){
 #ifdef BICOLOR_MATRIX
   if(_tgtBuffer >= BUFFER_SECONDARY || _tgtBuffer < 0) return;
@@ -481,6 +1240,7 @@ void HT1632Class::transition(char mode, int time){
   if(_tgtBuffer >= _numActivePins || _tgtBuffer < 0)
     return;
 #endif // BICOLOR_MATRIX
+  renderFinish(); // The render buffer is replaced as a whole.
   
   switch(mode) {
     case TRANSITION_BUFFER_SWAP:
@@ -514,7 +1274,104 @@ void HT1632Class::transition(char mode, int time){
       }
       break;
   }
-  
+
+}
+
+// Allocate one bit-plane per grayscale bit. Each plane has the same layout as a board buffer,
+//   so a plane can be moved into the output buffer one nibble at a time.
+bool HT1632Class::beginGrayscale(char bits, unsigned int tick) {
+  endGrayscale();
+  if(bits < 1 || bits > GRAYSCALE_MAX_BITS || _tgtBuffer >= BUFFER_SECONDARY || _tgtBuffer < 0)
+    return false;
+
+  for(char k = 0; k < bits; ++k) {
+    _grayPlanes[k] = (char *) malloc(ADDR_SPACE_SIZE);
+    if(_grayPlanes[k] == NULL) {
+      _grayBits = k;
+      endGrayscale();
+      return false;
+    }
+  }
+  _grayBits = bits;
+  _grayBuffer = _tgtBuffer;
+  _grayTick = tick;
+  _grayPlane = 0;
+  _grayDeadline = micros();
+  _grayPlanesShown = 0;
+  _grayRenderTime = 0;
+  clearGrayscale();
+  return true;
+}
+
+void HT1632Class::endGrayscale() {
+  for(char k = 0; k < _grayBits; ++k)
+    free(_grayPlanes[k]);
+  _grayBits = 0;
+}
+
+void HT1632Class::clearGrayscale() {
+  for(char k = 0; k < _grayBits; ++k)
+    for(int i = 0; i < ADDR_SPACE_SIZE; ++i)
+      _grayPlanes[k][i] = 0x00;
+}
+
+// Level is an integer between 0 and (1 << bits) - 1 (inclusive).
+// The pixel is clipped against the grayscale buffer, whatever the current draw target is.
+void HT1632Class::setGrayPixel(int loc_x, int loc_y, char level) {
+  toPhysical(loc_x, loc_y, OUT_SIZE, COM_SIZE);
+  if(loc_x < 0 || loc_x >= OUT_SIZE || loc_y < 0 || loc_y >= COM_SIZE)
+    return;
+  const int addr = GET_ADDR_FROM_X_Y(loc_x, loc_y);
+  const char bit = 1 << (loc_y % 4);
+
+  for(char k = 0; k < _grayBits; ++k, level >>= 1) {
+    if(level & 1)
+      _grayPlanes[k][addr] |= bit;
+    else
+      _grayPlanes[k][addr] &= ~bit;
+  }
+}
+
+// Show the next bit-plane once the time slot of the current one has elapsed. Plane k stays on
+//   screen for (tick << k) microseconds, so the perceived intensity of a pixel is proportional to
+//   its level. This is non-blocking; call it from loop(), not from an interrupt handler, since it
+//   renders over the same pins and buffers as the drawing functions.
+bool HT1632Class::updateGrayscale() {
+  if(_grayBits == 0)
+    return false;
+
+  unsigned long now = micros();
+  if((long)(now - _grayDeadline) < 0)
+    return false;
+
+  _grayPlane = (_grayPlane + 1) % _grayBits;
+  _grayDeadline = now + ((unsigned long)_grayTick << _grayPlane);
+
+  // Per-plane diff: only the nibbles that differ from what is on screen are marked for rewriting,
+  //   so render() only sends the pixels that change between the two planes.
+  renderFinish();
+  char * out = mem[_grayBuffer];
+  const char * plane = _grayPlanes[_grayPlane];
+  for(int i = 0; i < ADDR_SPACE_SIZE; ++i)
+    if((out[i] & 0b00001111) != plane[i])
+      out[i] = plane[i] | MASK_NEEDS_REWRITING;
+
+  char prevTarget = _tgtBuffer;
+  _tgtBuffer = _grayBuffer;
+  render();
+  _tgtBuffer = prevTarget;
+
+  _grayRenderTime += micros() - now;
+  ++_grayPlanesShown;
+  return true;
+}
+
+// Number of planes per second that the current transport (chip layout, pins and CPU) can sustain,
+//   based on the time actually spent rendering planes so far. Returns 0 until a plane was shown.
+unsigned long HT1632Class::getGrayscalePlaneRate() {
+  if(_grayRenderTime == 0)
+    return 0;
+  return (unsigned long)(_grayPlanesShown * 1000000.0 / _grayRenderTime);
 }
 
 
@@ -530,9 +1387,10 @@ void HT1632Class::writeCommand(char data) {
 // Integer write to display. Used to write commands/addresses.
 // PRECONDITION: WR is LOW
 void HT1632Class::writeData(char data, char len) {
+  STATS(_stats.wireBits += len)
   for(int j=len-1, t = 1 << (len - 1); j>=0; --j, t >>= 1){
     // Set the DATA pin to the correct state
-    digitalWrite(_pinDATA, ((data & t) == 0)?LOW:HIGH);
+    DATA_OUT(((data & t) == 0)?LOW:HIGH);
     NOP(); // Delay 
     // Raise the WR momentarily to allow the device to capture the data
     digitalWrite(_pinWR, HIGH);
@@ -544,9 +1402,11 @@ void HT1632Class::writeData(char data, char len) {
 // REVERSED Integer write to display. Used to write cell values.
 // PRECONDITION: WR is LOW
 void HT1632Class::writeDataRev(char data, char len) {
+  STATS(_stats.wireBits += len)
+  STATS(++_stats.nibblesWritten)
   for(int j=0; j<len; ++j){
     // Set the DATA pin to the correct state
-    digitalWrite(_pinDATA, data & 1);
+    DATA_OUT(data & 1);
     NOP(); // Delay
     // Raise the WR momentarily to allow the device to capture the data
     digitalWrite(_pinWR, HIGH);
@@ -556,11 +1416,63 @@ void HT1632Class::writeDataRev(char data, char len) {
     data >>= 1;
   }
 }
+// Render-ready write sessions.
+// render() does not clock words out one at a time: it packs the whole session (ID, address and
+//   words, with the bits of each word reversed) into _session, and sessionEnd() streams it with a
+//   loop that only shifts bytes.
+
+// Start a write session at chip address addr.
+void HT1632Class::sessionBegin(char addr) {
+  _sessionBits = 0;
+  sessionAppend(HT1632_ID_WR, HT1632_ID_LEN);
+  sessionAppend(addr, HT1632_ADDR_LEN);
+}
+
+void HT1632Class::sessionWord(char data) {
+  STATS(++_stats.nibblesWritten)
+  sessionAppend(REVERSED_NIBBLE[data & 0b00001111], HT1632_WORD_LEN);
+}
+
+// Append the len (at most 8) least significant bits of data to the session, most significant first.
+void HT1632Class::sessionAppend(unsigned char data, char len) {
+  const char offset = _sessionBits & 7;
+  const int index = _sessionBits >> 3;
+  const unsigned int bits = (unsigned int)(data & ((1 << len) - 1)) << (16 - offset - len);
+  // Bytes are assigned when the session first reaches them, so nothing needs clearing.
+  if(offset == 0)
+    _session[index] = bits >> 8;
+  else
+    _session[index] |= bits >> 8;
+  if(offset + len > 8)
+    _session[index + 1] = bits & 0xFF;
+  _sessionBits += len;
+}
+
+// Clock the session out. The chip must already be selected.
+// PRECONDITION: WR is LOW
+void HT1632Class::sessionEnd() {
+  STATS(_stats.wireBits += _sessionBits)
+  const unsigned char * next = _session;
+  for(int left = _sessionBits; left > 0; left -= 8) {
+    unsigned char bits = *next++;
+    for(char j = (left < 8) ? left : 8; j > 0; --j) {
+      DATA_OUT(bits & 0x80);
+      NOP(); // Delay
+      digitalWrite(_pinWR, HIGH);
+      NOP(); // Delay
+      digitalWrite(_pinWR, LOW);
+      bits <<= 1;
+    }
+  }
+  _sessionBits = 0;
+}
+
 // Write single bit to display, used as padding between commands.
 // PRECONDITION: WR is LOW
 void HT1632Class::writeSingleBit() {
+  STATS(++_stats.wireBits)
   // Set the DATA pin to the correct state
-  digitalWrite(_pinDATA, LOW);
+  DATA_OUT(LOW);
   NOP(); // Delay
   // Raise the WR momentarily to allow the device to capture the data
   digitalWrite(_pinWR, HIGH);
@@ -569,52 +1481,147 @@ void HT1632Class::writeSingleBit() {
   digitalWrite(_pinWR, LOW);
 }
 
+#if PARALLEL_DATA_CHAINS > 1
+// Set the DATA pins of all chains at once. bits holds the port bits (see _dataMask) to set HIGH.
+void HT1632Class::writeDataPort(unsigned char bits) {
+#ifdef RASPBERRY_PI
+  for(char k = 0; k < PARALLEL_DATA_CHAINS; ++k)
+    digitalWrite(_pinsDATA[k], (bits & _dataMask[k]) ? HIGH : LOW);
+#else // ifdef RASPBERRY_PI
+  // The rest of the port may be changed by interrupt handlers.
+  const unsigned char oldSREG = SREG;
+  cli();
+  *_dataPort = (*_dataPort & ~_dataAllMask) | bits;
+  SREG = oldSREG;
+#endif // ifdef RASPBERRY_PI
+}
+
+// REVERSED write of word addr of the given color, with each chain's own word on its own DATA pin.
+//   The words are transposed into one port value per bit, so every WR pulse clocks a bit into
+//   every chain.
+// PRECONDITION: WR is LOW
+void HT1632Class::writeDataRevParallel(int addr, char color) {
+  unsigned char bits [HT1632_WORD_LEN];
+  for(char j = 0; j < HT1632_WORD_LEN; ++j)
+    bits[j] = 0;
+  for(char k = 0; k < PARALLEL_DATA_CHAINS; ++k) {
+    const char data = mem[k * NUM_COLORS + color][addr];
+    for(char j = 0; j < HT1632_WORD_LEN; ++j)
+      if(data & (1 << j))
+        bits[j] |= _dataMask[k];
+  }
+
+  STATS(_stats.wireBits += HT1632_WORD_LEN)
+  STATS(++_stats.nibblesWritten)
+  for(char j = 0; j < HT1632_WORD_LEN; ++j) {
+    writeDataPort(bits[j]);
+    NOP(); // Delay
+    digitalWrite(_pinWR, HIGH);
+    NOP(); // Delay
+    digitalWrite(_pinWR, LOW);
+  }
+}
+#endif // PARALLEL_DATA_CHAINS > 1
+
+// REVERSED Integer read from display. Used to read cell values, least significant bit first.
+// The chip shifts each bit out on the falling edge of RD.
+// PRECONDITION: RD is HIGH and DATA is an INPUT
+char HT1632Class::readDataRev(char len) {
+  char data = 0;
+  for(char j=0; j<len; ++j){
+    digitalWrite(_pinRD, LOW);
+    NOP(); // Delay
+    if(digitalRead(_pinDATA) == HIGH)
+      data |= 1 << j;
+    digitalWrite(_pinRD, HIGH);
+  }
+  return data;
+}
+
 #ifdef BICOLOR_MATRIX
 
 //Output a clock pulse
 static inline void outputCLK_Pulse(char _pinCLK) { digitalWrite(_pinCLK, HIGH); digitalWrite(_pinCLK, LOW); }
 
+// Shift count copies of level into the CS shift register.
+static inline void shiftCS(char _pinForCS, char _pinCLK, char level, int count) {
+  digitalWrite(_pinForCS, level);
+  for(int tmp = 0; tmp < count; tmp++) outputCLK_Pulse(_pinCLK);
+}
+
 // Choose a chip. This function sets the correct CS line to LOW, and the rest to HIGH
 // Call the function with no arguments to deselect all chips.
-void HT1632Class::select(char mask) {
-  char tmp = 0;
+// The state of the shift register is tracked, so that the selection is only shifted as far as
+//   needed: from none or from a lower chip to chip mask (1 based), or out of the register.
+void HT1632Class::select(long mask) {
+  int pulses;
+  STATS(++_stats.selects)
 
   if (mask < 0) { // Enable all HT1632C
-    digitalWrite(_pinForCS, LOW);
-    for (tmp = 0; tmp < NUM_ACTIVE_CHIPS; tmp++) outputCLK_Pulse(_pinCLK);
+    pulses = NUM_ACTIVE_CHIPS;
+    shiftCS(_pinForCS, _pinCLK, LOW, pulses);
+    _csSelected = ALL_CHIPS;
   } else if (mask == 0) { //Disable all HT1632Cs
-    digitalWrite(_pinForCS, HIGH);
-    for(tmp = 0; tmp < NUM_ACTIVE_CHIPS; tmp++) outputCLK_Pulse(_pinCLK);
+    if(_csSelected == 0)
+      pulses = 0;
+    else if(_csSelected > 0)
+      pulses = NUM_ACTIVE_CHIPS - _csSelected + 1;  // Shift the selected chip out
+    else
+      pulses = NUM_ACTIVE_CHIPS;
+    shiftCS(_pinForCS, _pinCLK, HIGH, pulses);
+    _csSelected = 0;
   } else {
-    digitalWrite(_pinForCS, HIGH);
-    for(tmp = 0; tmp < NUM_ACTIVE_CHIPS; tmp++) outputCLK_Pulse(_pinCLK);
-    digitalWrite(_pinForCS, LOW);
-    outputCLK_Pulse(_pinCLK);
-    digitalWrite(_pinForCS, HIGH);
-    for(tmp = 1 ; tmp < mask; tmp++) outputCLK_Pulse(_pinCLK);
+    // Selecting the chip that is already selected must still restart its session.
+    if(_csSelected <= 0 || _csSelected >= mask) {
+      select(0);
+      shiftCS(_pinForCS, _pinCLK, LOW, 1);
+      _csSelected = 1;
+      pulses = 1;
+    } else
+      pulses = 0;
+    // Move the selection down the chain; every chip it leaves is deselected.
+    shiftCS(_pinForCS, _pinCLK, HIGH, mask - _csSelected);
+    pulses += mask - _csSelected;
+    _csSelected = mask;
   }
+  STATS(_stats.clkPulses += pulses)
 }
 void HT1632Class::select() {
   select(0);
 }
+// Select a single chip (0 based), or every chip with ALL_CHIPS.
+void HT1632Class::selectChip(int chip) {
+  if(chip == ALL_CHIPS)
+    select(-1);
+  else
+    select(chip + 1);  // 1 based
+}
 
 #else // BICOLOR_MATRIX
 
 // Choose a chip. This function sets the correct CS line to LOW, and the rest to HIGH
 // Call the function with no arguments to deselect all chips.
-// Call the function with a bitmask (0b4321) to select specific chips. 0b1111 selects all. 
-void HT1632Class::select(char mask) {
-  for(int i=0, t=1; i<_numActivePins; ++i, t <<= 1){
-    digitalWrite(_pinCS[i], (t & mask)?LOW:HIGH);
-    /*Serial.write(48+_pinCS[i]);
-    Serial.write((t & mask)?"LOW":"HIGH");
-    Serial.write('\n');
-  */}
-  //Serial.write('\n');
+// Call the function with a bitmask (0b4321) to select specific chips. 0b1111 selects all 4.
+// Only the CS pins that change are written.
+void HT1632Class::select(long mask) {
+  if(mask != 0 && mask == _csMask)
+    select(); // Restart the sessions of the chips that are already selected.
+  STATS(++_stats.selects)
+  long t = 1;
+  for(int i=0; i<_numActivePins; ++i, t <<= 1)
+    if((mask ^ _csMask) & t)
+      digitalWrite(_pinCS[i], (t & mask)?LOW:HIGH);
+  _csMask = mask;
 }
 void HT1632Class::select() {
-  for(int i=0; i<_numActivePins; ++i)
-    digitalWrite(_pinCS[i], HIGH);
+  select(0);
+}
+// Select a single chip (0 based), or every chip with ALL_CHIPS.
+void HT1632Class::selectChip(int chip) {
+  if(chip == ALL_CHIPS)
+    select((1L << _numActivePins) - 1);
+  else
+    select(1L << chip);
 }
 
 #endif // BICOLOR_MATRIX
@@ -624,7 +1631,60 @@ void HT1632Class::select() {
  * "Would you like some fries with that?"
  */
 
-void HT1632Class::recursiveWriteUInt (int inp) {
+#ifdef HT1632_STATS
+
+HT1632Stats HT1632Class::getStats() {
+  return _stats;
+}
+
+void HT1632Class::resetStats() {
+  _stats.wireBits = 0;
+  _stats.nibblesWritten = 0;
+  _stats.sessions = 0;
+  _stats.selects = 0;
+  _stats.clkPulses = 0;
+  _stats.renders = 0;
+  _stats.fullRewrites = 0;
+  _stats.renderMicros = 0;
+  _stats.lastRenderMicros = 0;
+}
+
+// Write the counters to Serial, one "name value" pair per line.
+void HT1632Class::writeStats() {
+  writeStat("wireBits", _stats.wireBits);
+  writeStat("nibblesWritten", _stats.nibblesWritten);
+  writeStat("sessions", _stats.sessions);
+  writeStat("selects", _stats.selects);
+  writeStat("clkPulses", _stats.clkPulses);
+  writeStat("renders", _stats.renders);
+  writeStat("fullRewrites", _stats.fullRewrites);
+  writeStat("renderMicros", _stats.renderMicros);
+  writeStat("lastRenderMicros", _stats.lastRenderMicros);
+}
+
+void HT1632Class::writeStat(const char * name, unsigned long value) {
+#ifndef RASPBERRY_PI
+  Serial.write(name);
+  Serial.write(' ');
+  writeInt(value);
+  Serial.write('\n');
+#endif // ifndef RASPBERRY_PI
+}
+
+void HT1632Class::statsRenderStarted(char buffer) {
+  ++_stats.renders;
+  if(_globalNeedsRewriting[buffer])
+    ++_stats.fullRewrites;
+}
+
+void HT1632Class::statsRenderDone(unsigned long start) {
+  _stats.lastRenderMicros = micros() - start;
+  _stats.renderMicros += _stats.lastRenderMicros;
+}
+
+#endif // HT1632_STATS
+
+void HT1632Class::recursiveWriteUInt (unsigned long inp) {
 #ifndef RASPBERRY_PI
   if(inp <= 0) return;
   int rd = inp % 10;
@@ -633,7 +1693,7 @@ void HT1632Class::recursiveWriteUInt (int inp) {
 #endif // ifndef RASPBERRY_PI
 }
 
-void HT1632Class::writeInt (int inp) {
+void HT1632Class::writeInt (long inp) {
 #ifndef RASPBERRY_PI
   if(inp == 0)
     Serial.write('0');
@@ -646,5 +1706,48 @@ void HT1632Class::writeInt (int inp) {
 #endif // ifndef RASPBERRY_PI
 }
 
+// Checksum (CRC-16/CCITT) of the pixels of the current target buffer. Two buffers with the same
+//   pixels have the same checksum, whatever their rendering state.
+//   In BUFFER_TILED, the buffers of the boards are checksummed one after the other, in tile order.
+unsigned int HT1632Class::getBufferChecksum() {
+  const char * buffers [MAX_BOARDS];
+  char numBuffers = 1;
+  buffers[0] = mem[_tgtBuffer < MAX_BOARDS ? _tgtBuffer : 0];
+#ifndef BICOLOR_MATRIX
+  if(_tgtBuffer == BUFFER_TILED)
+    for(numBuffers = 0; numBuffers < _tileColumns * _tileRows; ++numBuffers)
+      buffers[numBuffers] = mem[_tileBoard[numBuffers]];
+#endif // BICOLOR_MATRIX
+
+  unsigned int crc = 0xFFFF;
+  for(char n = 0; n < numBuffers; ++n)
+    for(int i = 0; i < ADDR_SPACE_SIZE; ++i) {
+      crc ^= (unsigned int)(buffers[n][i] & 0b00001111) << 8;
+      for(char b = 0; b < 8; ++b)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+  return crc & 0xFFFF;
+}
+
+// Export the current target buffer as text, one line per row, '#' for lit pixels and '.' for
+//   others. Written to Serial (or to the standard output on the Raspberry Pi).
+void HT1632Class::dumpBuffer() {
+  for(int y = 0; y < physicalHeight(); ++y) {
+    for(int x = 0; x < physicalWidth(); ++x) {
+      const char c = (*cellAt(x, y, false) & (1 << (y % 4))) ? '#' : '.';
+#ifdef RASPBERRY_PI
+      putchar(c);
+#else // ifdef RASPBERRY_PI
+      Serial.write(c);
+#endif // ifdef RASPBERRY_PI
+    }
+#ifdef RASPBERRY_PI
+    putchar('\n');
+#else // ifdef RASPBERRY_PI
+    Serial.write('\n');
+#endif // ifdef RASPBERRY_PI
+  }
+}
+
 HT1632Class HT1632;
 
@@ -18,25 +18,46 @@
 
 // Uncomment line below in order to have this library supporting the bicolor
 // sure electronics DE-DP14112 (P4 32X16 RG Bicolor LED Dot Matrix Unit Board)
+// (single-color boards can also be chosen on the compiler command line, with -DSINGLE_COLOR_MATRIX)
+#ifndef SINGLE_COLOR_MATRIX
 #define BICOLOR_MATRIX 1
+#endif
 
 // Important: make sure you change the number of sure electronics DE-DP14112
-// to represent how many units are daisy chainned together
+// to represent how many units are daisy chainned together (it can also be set on the compiler
+// command line, e.g. -DNUM_OF_BICOLOR_UNITS=4)
+#ifndef NUM_OF_BICOLOR_UNITS
 #define NUM_OF_BICOLOR_UNITS 1
+#endif
+
+// Number of bicolor chains driven in lockstep. The chains share the CS, CLK and WR pins, and each
+// one has its own DATA pin; every bit is clocked into all chains at once, so N chains refresh
+// almost as fast as one. The DATA pins must all be on the same port (at most 8 chains), so that a
+// single port write sets them all. See begin() and BUFFER_CHAIN().
+#define PARALLEL_DATA_CHAINS 1
 
 #ifdef BICOLOR_MATRIX
 #define COM_SIZE 16   /* max_number_of_y */
 #define OUT_SIZE (32 * NUM_OF_BICOLOR_UNITS)  /* max_number_of_x */
 #define NUM_ACTIVE_CHIPS (OUT_SIZE / 8)
 #define NUM_COLORS 2  /* aka boards: 1)green and 2)red */
-#define MAX_BOARDS (NUM_COLORS + 1)  /* includes SECONDARY */
+#define MAX_BOARDS (NUM_COLORS * PARALLEL_DATA_CHAINS + 1)  /* includes SECONDARY */
 #else // BICOLOR_MATRIX
 // Size of COM and OUT in bits:
 #define COM_SIZE 8
 #define OUT_SIZE 32
 // COM_SIZE MUST be either 8 or 16.
+// Maximum number of boards, each on its own CS pin (at most 31). Every board that is used costs
+//   ADDR_SPACE_SIZE bytes of memory.
+#define MAX_CS_PINS 4
 #define NUM_COLORS 1
-#define MAX_BOARDS 5  /* includes SECONDARY */
+#define MAX_BOARDS (MAX_CS_PINS + 1)  /* includes SECONDARY */
+#if MAX_CS_PINS > 31
+#error MAX_CS_PINS must be at most 31. Change the values in HT1632.h.
+#endif
+#if PARALLEL_DATA_CHAINS != 1
+#error PARALLEL_DATA_CHAINS requires BICOLOR_MATRIX. Change the values in HT1632.h.
+#endif
 #endif // BICOLOR_MATRIX
 
 // Target buffer
@@ -45,9 +66,18 @@
 //   itself. All calls to any drawing function (including clear()) only affect the selected buffer
 //   of the selected board. you can move the contents of the secondary buffer to the render
 //   buffer by calling transition(), with an appropriate transition. See transition() for more details.
-// board_num = [1..4]
+// board_num = [1..MAX_CS_PINS], or [1..NUM_COLORS] on bicolor boards
 #define BUFFER_BOARD(board_num) ((board_num)-1)
 #define BUFFER_SECONDARY        ((MAX_BOARDS)-1)
+// With PARALLEL_DATA_CHAINS, each chain has its own render buffer per color. Rendering one of them
+//   renders that color on every chain. BUFFER_CHAIN(1, n) is BUFFER_BOARD(n).
+// chain_num = [1..PARALLEL_DATA_CHAINS]
+#define BUFFER_CHAIN(chain_num, board_num) (((chain_num)-1) * NUM_COLORS + (board_num)-1)
+#ifndef BICOLOR_MATRIX
+// The boards arranged by setTiling(), drawn as one display of getWidth() x getHeight() pixels.
+//   Drawing functions clip to the whole arrangement and write each pixel to the board under it.
+#define BUFFER_TILED            (MAX_BOARDS)
+#endif // BICOLOR_MATRIX
 
 // Transition Modes
 // Transitions copies the contents of the "secondary" buffer to the currently selected board buffer.
@@ -63,6 +93,41 @@
 #define TRANSITION_FADE            0x02
   // Uses the PWM feature to fade through black. Does not preserve current brightness level.
 #define TRANSITION_WIPE_FROM_RIGHT 0x03
+
+// Raster operations
+// Controls how the pixels of an image (or text) are combined with the contents of the target
+//   buffer by drawImage() and drawText(). Only the area covered by the image is affected.
+#define ROP_COPY    0x00
+  // Overwrite the target with the image. This is the default.
+#define ROP_OR      0x01
+  // Set the pixels that are set in the image, leaving the rest untouched (transparent overlay).
+#define ROP_AND     0x02
+  // Clear the pixels that are not set in the image (masking).
+#define ROP_XOR     0x03
+  // Invert the pixels that are set in the image. Drawing the same image twice restores the target.
+#define ROP_AND_NOT 0x04
+  // Clear the pixels that are set in the image (erase).
+
+// Orientation
+// Pass a rotation, optionally combined with MIRROR_X and/or MIRROR_Y, to setOrientation() for boards
+//   that are mounted upside down or in portrait. Drawing coordinates then follow the orientation,
+//   and getWidth() and getHeight() are swapped when rotating by 90 or 270 degrees. The buffers, and
+//   functions that work on them directly (render(), dumpBuffer(), streams...), are not affected.
+#define ROTATE_0   0x00
+#define ROTATE_90  0x01  /* Clockwise */
+#define ROTATE_180 0x02
+#define ROTATE_270 0x03
+#define MIRROR_X   0x04  /* Mirror the x axis (left becomes right), before the rotation */
+#define MIRROR_Y   0x08  /* Mirror the y axis (top becomes bottom), before the rotation */
+
+// Grayscale
+// The HT1632 only has a global PWM setting, so per-pixel intensity is emulated in software by
+//   storing each pixel as a level made of GRAYSCALE bit-planes. updateGrayscale() cycles through
+//   the planes, showing plane k for (tick << k) microseconds (binary code modulation). Only the
+//   nibbles that differ between two consecutive planes are rewritten when switching planes.
+#define GRAYSCALE_MAX_BITS     4
+#define GRAYSCALE_DEFAULT_TICK 250  /* Duration of the least significant plane, in microseconds */
+
 // Wrap settings
 // For advanced rendering (currently only text rendering)
 
@@ -75,10 +140,16 @@
 // There are known issues with this. If the default doesn't work,
 // try changing the value.
 
+// Uncomment line below to collect render statistics (bits and words sent, chip selections, render
+//   time...), see getStats(). This is used by the benchmark sketch, and costs a little time on
+//   every bit sent.
+//#define HT1632_STATS 1
+
 #ifdef BICOLOR_MATRIX
 
+// Both are ints, so that chains of more than 32 units (128 chips) can be addressed.
 #define GET_CHIP_FROM_X_Y(_x,_y) (((_x)/16)+((_y)>7?2:0)+(((_x)/32)*2)) /* 0 based */
-#define GET_ADDR_FROM_X_Y(_x,_y) (((_x)%16)*2)+(((_y)%8)/4) + GET_CHIP_FROM_X_Y(_x,_y)*32
+#define GET_ADDR_FROM_X_Y(_x,_y) ((((_x)%16)*2)+(((_y)%8)/4) + GET_CHIP_FROM_X_Y(_x,_y)*32)
 
 #else // BICOLOR_MATRIX
 
@@ -95,6 +166,15 @@
 // Meta-data masks
 #define MASK_NEEDS_REWRITING 0b00010000
 
+// Number of chips, and number of 4-bit words of each chip per color.
+#ifdef BICOLOR_MATRIX
+#define MAX_CHIPS  NUM_ACTIVE_CHIPS
+#define CHIP_WORDS 32
+#else // BICOLOR_MATRIX
+#define MAX_CHIPS  (MAX_BOARDS - 1)
+#define CHIP_WORDS ADDR_SPACE_SIZE
+#endif // BICOLOR_MATRIX
+
 // Round up to multiple of 4 function
 
 // NO-OP Definition
@@ -132,53 +212,219 @@
 #define HT1632_ADDR_LEN   7	/* Addresses are 7 bits long */
 #define HT1632_WORD_LEN   4     /* Words are 4 bits long */
 
+// Command queue
+// Commands queued with queueCommand() are sent together by flushCommands(), with several commands
+//   per chip selection. ALL_CHIPS sends a command to every chip with a single selection.
+#define COMMAND_QUEUE_SIZE 8
+#define ALL_CHIPS          -1
+
+// Longest write session sent by render(): ID, address and the words of one chip in one color.
+#define SESSION_MAX_BITS (HT1632_ID_LEN + HT1632_ADDR_LEN + CHIP_WORDS * HT1632_WORD_LEN)
+
+#ifdef HT1632_STATS
+struct HT1632Stats {
+  unsigned long wireBits;         // Bits clocked into the chips with WR (IDs, addresses, data, commands)
+  unsigned long nibblesWritten;   // 4-bit words written to the chips' memory
+  unsigned long sessions;         // Write sessions opened (chip selection + ID + address)
+  unsigned long selects;          // Calls to select()
+  unsigned long clkPulses;        // Pulses of the CS shift register clock (bicolor boards only)
+  unsigned long renders;          // Calls to render() on a renderable buffer
+  unsigned long fullRewrites;     // Renders that rewrote the whole buffer, e.g. after a buffer swap
+  unsigned long renderMicros;     // Total time spent in render()
+  unsigned long lastRenderMicros; // Time spent in the last render()
+};
+#endif // HT1632_STATS
+
 class HT1632Class
 {
   private:  
 #ifdef BICOLOR_MATRIX
     char _pinForCS;
     char _pinCLK;
+    int _csSelected; // Chip selected by the CS shift register (1 based), 0 for none, ALL_CHIPS for all
+#if PARALLEL_DATA_CHAINS > 1
+    char _pinsDATA [PARALLEL_DATA_CHAINS];
+    unsigned char _dataMask [PARALLEL_DATA_CHAINS]; // Port bit of the DATA pin of each chain
+    unsigned char _dataAllMask;
+#ifndef RASPBERRY_PI
+    volatile unsigned char * _dataPort;
+#endif // ifndef RASPBERRY_PI
+    void writeDataPort(unsigned char bits);
+    void writeDataRevParallel(int addr, char color);
+#endif // PARALLEL_DATA_CHAINS > 1
 #else // BICOLOR_MATRIX
-    char _pinCS [4];
+    char _pinCS [MAX_CS_PINS];
     char _numActivePins;
+    long _csMask;    // CS pins that are LOW
+    char _tileColumns;
+    char _tileRows;
+    char _tileBoard [MAX_CHIPS];
 #endif // BICOLOR_MATRIX
     char _pinWR;
     char _pinDATA;
+    char _pinRD;
+    bool _canRead;
+    int _scrubChip;
     char _tgtBuffer;
     char _globalNeedsRewriting [MAX_BOARDS];
     char * mem [MAX_BOARDS];
+    char * _grayPlanes [GRAYSCALE_MAX_BITS];
+    char _grayBits;
+    char _grayBuffer;
+    char _grayPlane;
+    unsigned int _grayTick;
+    unsigned long _grayDeadline;
+    unsigned long _grayPlanesShown;
+    unsigned long _grayRenderTime;
     void writeCommand(char);
     void writeData(char, char);
     void writeDataRev(char, char);
     void writeSingleBit();
+    char readDataRev(char);
+    bool scrubWords(long selectionmask, char addr, char * buffer, int count);
     void initialize(int, int);
     void select();
-    void select(char mask);
+    void select(long mask);
+    char _cmdQueue [COMMAND_QUEUE_SIZE];
+    int _cmdChip [COMMAND_QUEUE_SIZE];
+    char _numQueuedCommands;
+    bool _powerSaving;
+    bool _chipAsleep [MAX_CHIPS];
+    char * chipWords(char color, int chip);
+    void updateChipPower(int chip);
+    void rewriteChip(int chip);
+    void selectChip(int chip);
+    void openCommandSession(int chip);
+    void closeCommandSession();
+    char _orientation;
+    bool _swapXY;
+    bool _flipX;
+    bool _flipY;
+    int physicalWidth();
+    int physicalHeight();
+    void toPhysical(int & loc_x, int & loc_y, int width, int height);
+    char * cellAt(int loc_x, int loc_y, bool modify = true);
+    void writeCell(char * cell, char mask, char data, char rop = ROP_COPY);
+    void writeNibble(int loc_x, int loc_y, char mask, char data, char rop = ROP_COPY);
+    void drawImageTransposed(const char * img, char width, char height, int x, int y, int offset, char rop);
+    // Pipelined render in progress: chips (boards, or tiles of BUFFER_TILED, without BICOLOR_MATRIX)
+    //   _pipeNext to _pipeEnd - 1 of _pipeTarget are not sent yet.
+    char _pipeTarget;
+    int _pipeNext;
+    int _pipeEnd;
+    void renderBarrier(char buffer, int addr);
+#ifdef BICOLOR_MATRIX
+    void renderChip(int chip);
+#else // BICOLOR_MATRIX
+    void renderBoard(char board);
+#endif // BICOLOR_MATRIX
+    // Bits of the write session being prepared by render(), most significant first and ready to
+    //   be clocked out: ID, address, then each word with its bits reversed.
+    unsigned char _session [(SESSION_MAX_BITS + 7) / 8];
+    int _sessionBits;
+    void sessionBegin(char addr);
+    void sessionWord(char data);
+    void sessionAppend(unsigned char data, char len);
+    void sessionEnd();
+    // Decode streamed frames, and copy canvas viewports and bitplanes straight into the buffers
+    //   with writeNibble().
+    friend class HT1632Receiver;
+    friend class HT1632Canvas;
+    friend class HT1632Bitplane;
+    
+#ifdef HT1632_STATS
+    HT1632Stats _stats;
+    unsigned long _renderStart;
+    void statsRenderStarted(char buffer);
+    void statsRenderDone(unsigned long start);
+    void writeStat(const char * name, unsigned long value);
+#endif // HT1632_STATS
     
     // Debugging functions, write to Serial.
-    void writeInt(int);
-    void recursiveWriteUInt(int);
+    void writeInt(long);
+    void recursiveWriteUInt(unsigned long);
     
   public:
+    // Frees the buffers, for instances created with new (the class has no constructor, so they
+    //   must be value-initialized: new HT1632Class()).
+    ~HT1632Class();
 #ifdef BICOLOR_MATRIX
+#if PARALLEL_DATA_CHAINS > 1
+    // pinsDATA holds the DATA pin of each of the PARALLEL_DATA_CHAINS chains.
+    void begin(int pinCS, int pinWR,  const int pinsDATA [], int pinCLK);
+#else // PARALLEL_DATA_CHAINS > 1
     void begin(int pinCS, int pinWR,  int pinDATA, int pinCLK);
+#endif // PARALLEL_DATA_CHAINS > 1
 #else // BICOLOR_MATRIX
     void begin(int pinCS1, int pinWR,  int pinDATA);
     void begin(int pinCS1, int pinCS2, int pinWR,   int pinDATA);
     void begin(int pinCS1, int pinCS2, int pinCS3,  int pinWR,   int pinDATA);
     void begin(int pinCS1, int pinCS2, int pinCS3,  int pinCS4,  int pinWR,   int pinDATA);
+    // Any number of boards, up to MAX_CS_PINS. pinsCS holds the CS pin of each board.
+    void begin(const int pinsCS [], int numPins, int pinWR, int pinDATA);
+    // Arrange the boards in columns x rows for BUFFER_TILED. boards lists the BUFFER_BOARD() of
+    //   each position, row by row; by default the boards are in the order of their CS pins.
+    //   begin() puts all the boards side by side.
+    bool setTiling(char columns, char rows = 1, const char boards [] = 0);
 #endif // BICOLOR_MATRIX
+    // Size of the current draw target, in pixels, in the current orientation.
+    int getWidth();
+    int getHeight();
+    void setOrientation(char orientation);
+    char getOrientation();
     void sendCommand(char command);
     void drawTarget(char targetBuffer);
     void render();
+    // Pipelined render(): renderBegin() starts a render, each renderStep() sends the next chip (board
+    //   without BICOLOR_MATRIX) and returns false when none is left, and renderFinish() sends the rest.
+    //   The next frame can be drawn between the steps.
+    void renderBegin();
+    bool renderStep();
+    void renderFinish();
     void transition(char mode, int time = 1000); // Time is in miliseconds.
     void clear();
+    void copyRegion(char sourceBuffer, int x, int y, int width, int height);
     void setPixel(int loc_x, int loc_y, bool datum = true);
-    void drawImage(const char * img, char width, char height, int x, int y, int offset = 0);
+    // Whether the pixel is lit in the current draw target (false outside of it).
+    bool getPixel(int loc_x, int loc_y);
+    void drawHLine(int x, int y, int length, bool datum = true);
+    void drawVLine(int x, int y, int length, bool datum = true);
+    void drawLine(int x0, int y0, int x1, int y1, bool datum = true);
+    void drawRect(int x, int y, int width, int height, bool datum = true);
+    void fillRect(int x, int y, int width, int height, bool datum = true);
+    void drawCircle(int x0, int y0, int radius, bool datum = true);
+    void drawImage(const char * img, char width, char height, int x, int y, int offset = 0, char rop = ROP_COPY);
     void drawText(const char [], int x, int y, const char font [], const char font_width [], char font_height,
-		  int font_glyph_step, char gutter_space = 1);
+		  int font_glyph_step, char gutter_space = 1, char rop = ROP_COPY);
     int getTextWidth(const char [], const char font_width [], char font_height, char gutter_space = 1);
-    void setBrightness(char brightness, char selectionmask = 0b00010000);
+    // selectionmask has one bit per board; 0 is the board(s) of the current draw target.
+    void setBrightness(char brightness, long selectionmask = 0);
+    // Does nothing with PARALLEL_DATA_CHAINS: the chains have no common DATA pin to read from, so
+    //   scrub() always returns false.
+    void setReadPin(int pinRD);
+    bool scrub();
+    void setBlink(bool blink, int chip = ALL_CHIPS);
+    void setPower(bool on, int chip = ALL_CHIPS);
+    // Does nothing with PARALLEL_DATA_CHAINS: the chips are shared by the chains, and one may only
+    //   sleep if it is blank in all of them.
+    void setPowerSaving(bool enabled);
+    unsigned int getBufferChecksum();
+    void dumpBuffer();
+#ifdef HT1632_STATS
+    HT1632Stats getStats();
+    void resetStats();
+    void writeStats();
+#endif // HT1632_STATS
+    void queueCommand(char command, int chip = ALL_CHIPS);
+    void flushCommands();
+
+    // Grayscale mode. The current draw target becomes the grayscale output buffer.
+    bool beginGrayscale(char bits, unsigned int tick = GRAYSCALE_DEFAULT_TICK);
+    void endGrayscale();
+    void clearGrayscale();
+    void setGrayPixel(int loc_x, int loc_y, char level);
+    bool updateGrayscale(); // Call as often as possible; returns true if a plane was shown.
+    unsigned long getGrayscalePlaneRate(); // Measured planes per second the transport sustains.
 };
 
 extern HT1632Class HT1632;
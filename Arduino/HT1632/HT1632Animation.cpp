@@ -0,0 +1,136 @@
+#include "HT1632Animation.h"
+
+#ifdef RASPBERRY_PI
+
+#include <wiringPi.h>
+#define ANIM_READ(p) (*(const unsigned char *)(p))
+
+#else // ifdef RASPBERRY_PI
+
+#if (ARDUINO >= 100)
+  #include <Arduino.h>
+#else
+  #include <WProgram.h>
+#endif
+#define ANIM_READ(p) ((unsigned char)pgm_read_byte(p))
+
+#endif // ifdef RASPBERRY_PI
+
+// Check the header of anim, that drawImage() can draw its frames, and that the delta frames only
+//   list words of the frame, which can all be indexed with a single byte.
+static bool isValid(const char * anim) {
+  const int frames = ANIM_READ(&anim[2]);
+  if(frames == 0 || ANIM_READ(&anim[3]) >= frames)
+    return false;
+  if(ANIM_READ(&anim[0]) > ANIM_MAX_SIZE || ANIM_READ(&anim[1]) > ANIM_MAX_SIZE)
+    return false;
+
+  const int words = ANIM_READ(&anim[0]) * ((ANIM_READ(&anim[1]) + 3) / 4);
+  const char * frame = anim + ANIM_HEADER_LEN;
+  for(int f = 0; f < frames; ++f) {
+    if(ANIM_READ(&frame[0]) == ANIM_FRAME_FULL) {
+      frame += 3 + words;
+      continue;
+    }
+    if(words > ANIM_MAX_DELTA_WORDS)
+      return false;
+    const int count = ANIM_READ(&frame[3]);
+    for(int k = 0; k < count; ++k)
+      if(ANIM_READ(&frame[4 + 2*k]) >= words)
+        return false;
+    frame += 4 + 2 * count;
+  }
+  return true;
+}
+
+HT1632Animation::HT1632Animation() {
+  _anim = 0;
+  _playing = false;
+}
+
+bool HT1632Animation::play(const char * anim, int x, int y, bool loop) {
+  _playing = false;
+  if(!isValid(anim))
+    return false;
+
+  _anim = anim;
+  _nextFrame = anim + ANIM_HEADER_LEN;
+  _x = x;
+  _y = y;
+  _frame = 0;
+  _loop = loop;
+  _playing = true;
+  _due = millis();
+  return true;
+}
+
+void HT1632Animation::stop() {
+  _playing = false;
+}
+
+bool HT1632Animation::isPlaying() {
+  return _playing;
+}
+
+bool HT1632Animation::update() {
+  if(!_playing)
+    return false;
+
+  unsigned long now = millis();
+  if((long)(now - _due) < 0)
+    return false;
+
+  unsigned int duration;
+  _nextFrame = applyFrame(_nextFrame, &duration);
+
+  // Keep a steady pace, unless we fell behind by more than a frame.
+  _due += duration;
+  if((long)(now - _due) >= 0)
+    _due = now + duration;
+
+  if(++_frame >= ANIM_READ(&_anim[2])) {
+    if(_loop) {
+      // Skip to the frame to restart from.
+      _nextFrame = _anim + ANIM_HEADER_LEN;
+      for(_frame = 0; _frame < ANIM_READ(&_anim[3]); ++_frame)
+        _nextFrame = applyFrame(_nextFrame, 0);
+    } else {
+      _playing = false;
+    }
+  }
+  return true;
+}
+
+// Draw the frame starting at frame, and return the start of the next one. If duration is NULL,
+//   nothing is drawn and the frame is only skipped.
+const char * HT1632Animation::applyFrame(const char * frame, unsigned int * duration) {
+  const int width = ANIM_READ(&_anim[0]);
+  const int height = ANIM_READ(&_anim[1]);
+  const int rows = (height + 3) / 4;
+  const char type = ANIM_READ(&frame[0]);
+
+  if(duration)
+    *duration = ANIM_READ(&frame[1]) | (ANIM_READ(&frame[2]) << 8);
+  frame += 3;
+
+  if(type == ANIM_FRAME_FULL) {
+    if(duration)
+      HT1632.drawImage(frame, width, height, _x, _y);
+    return frame + width * rows;
+  }
+
+  // ANIM_FRAME_DELTA
+  const int count = ANIM_READ(&frame[0]);
+  ++frame;
+  if(duration) {
+    for(int k = 0; k < count; ++k) {
+      const int index = ANIM_READ(&frame[2*k]);
+      const int column = index / rows;
+      const int row = index % rows;
+      const char rowHeight = (height - 4*row < 4) ? (height - 4*row) : 4;
+      // Each entry is a one-word image, XORed into place.
+      HT1632.drawImage(&frame[2*k + 1], 1, rowHeight, _x + column, _y + 4*row, 0, ROP_XOR);
+    }
+  }
+  return frame + 2 * count;
+}
@@ -0,0 +1,66 @@
+/*
+  HT1632Animation.h - Non-blocking frame-sequence player for the HT1632
+  library. Animations are stored in PROGMEM and played into the current
+  draw target, one frame at a time, whenever update() finds that the
+  current frame has been shown long enough.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Animation_h
+#define HT1632Animation_h
+
+#include "HT1632.h"
+
+// Animation format
+// An animation is a PROGMEM char array made of a 4-byte header followed by the frames:
+//   width, height, number of frames, frame to restart from when looping
+// Each frame starts with its type and the time it stays on screen (use ANIM_DURATION), followed by:
+//   ANIM_FRAME_FULL:  width * ceil(height/4) words, in the same layout as the images of drawImage().
+//   ANIM_FRAME_DELTA: a count n, then n pairs of (word index, bits to XOR into that word), where the
+//                     word index is column * ceil(height/4) + row. Only the words that differ from
+//                     the previous frame are stored, so long animations stay small and only the
+//                     changed pixels are rewritten.
+// The first frame should be a full frame. Delta frames are applied to whatever is on screen, so
+//   the frame to restart from must follow a frame that produces the same image as the last one.
+// Frames are drawn with drawImage(), which takes the size as a char: animations can be at most
+//   ANIM_MAX_SIZE pixels wide and high. Word indices and counts are single bytes: animations with
+//   delta frames can be at most ANIM_MAX_DELTA_WORDS words (e.g. 64x16 or 127x8 pixels), and a
+//   delta frame lists at most 255 words. Use a full frame when more words change. play() rejects
+//   animations that break these limits.
+#define ANIM_FRAME_FULL  0x00
+#define ANIM_FRAME_DELTA 0x01
+#define ANIM_DURATION(ms) (char)((ms) & 0xFF), (char)(((ms) >> 8) & 0xFF)
+#define ANIM_HEADER_LEN  4
+#define ANIM_MAX_SIZE    127
+#define ANIM_MAX_DELTA_WORDS 256
+
+class HT1632Animation
+{
+  private:
+    const char * _anim;
+    const char * _nextFrame;
+    int _x;
+    int _y;
+    unsigned char _frame; // Up to 255 frames
+    bool _loop;
+    bool _playing;
+    unsigned long _due;
+    const char * applyFrame(const char * frame, unsigned int * duration);
+
+  public:
+    HT1632Animation();
+    // Start playing anim with its top-left corner at (x, y). The first frame is drawn by the next
+    //   call to update(). Returns false, and stops playing, if anim has no frames, restarts from a
+    //   frame it does not have, is too large for drawImage(), or has a delta frame that breaks the
+    //   limits of the format.
+    bool play(const char * anim, int x, int y, bool loop = true);
+    void stop();
+    bool isPlaying();
+    // Draw the next frame into the current draw target if it is due. Returns true if the buffer
+    //   changed, in which case render() should be called. Never blocks.
+    bool update();
+};
+
+#else
+//#error "HT1632Animation.h" already defined!
+#endif
@@ -0,0 +1,151 @@
+#include "HT1632Canvas.h"
+
+#ifdef RASPBERRY_PI
+
+#include <string.h>
+#define CANVAS_READ(p) (*(const char *)(p))
+
+#else // ifdef RASPBERRY_PI
+
+#if (ARDUINO >= 100)
+  #include <Arduino.h>
+#else
+  #include <WProgram.h>
+#endif
+#define CANVAS_READ(p) ((char)pgm_read_byte(p))
+
+#endif // ifdef RASPBERRY_PI
+
+HT1632Canvas::HT1632Canvas(unsigned char * buffer, int width, int height) {
+  _bits = buffer;
+  _width = width;
+  _height = height;
+  _columnBytes = (height + 7) / 8;
+}
+
+int HT1632Canvas::getWidth() {
+  return _width;
+}
+
+int HT1632Canvas::getHeight() {
+  return _height;
+}
+
+void HT1632Canvas::clear() {
+  memset(_bits, 0, CANVAS_BYTES(_width, _height));
+}
+
+void HT1632Canvas::setPixel(int x, int y, bool datum) {
+  writePixel(x, y, datum, ROP_COPY);
+}
+
+bool HT1632Canvas::getPixel(int x, int y) {
+  if(x < 0 || x >= _width || y < 0 || y >= _height)
+    return false;
+  return _bits[x * _columnBytes + y / 8] & (1 << (y % 8));
+}
+
+// Combine datum with pixel (x, y) using rop, see ROP_COPY and friends. Pixels outside the canvas
+//   are ignored.
+void HT1632Canvas::writePixel(int x, int y, bool datum, char rop) {
+  if(x < 0 || x >= _width || y < 0 || y >= _height)
+    return;
+  unsigned char * cell = &_bits[x * _columnBytes + y / 8];
+  const unsigned char bit = 1 << (y % 8);
+  const bool curr = *cell & bit;
+  bool next;
+  switch(rop) {
+    case ROP_OR:      next = curr || datum;  break;
+    case ROP_AND:     next = curr && datum;  break;
+    case ROP_XOR:     next = curr != datum;  break;
+    case ROP_AND_NOT: next = curr && !datum; break;
+    default:          next = datum;          break; // ROP_COPY
+  }
+  if(next)
+    *cell |= bit;
+  else
+    *cell &= ~bit;
+}
+
+void HT1632Canvas::drawImage(const char * img, char width, char height, int x, int y, int offset, char rop) {
+  if(y + height <= 0 || x + width <= 0 || y >= _height || x >= _width)
+    return;
+
+  const int rows = (height + 3) / 4; // Number of 4-bit words per column of img.
+  for(char i = 0; i < width; ++i) {
+    if(x + i < 0 || x + i >= _width)
+      continue;
+    const char * column = &img[rows * i + offset];
+    for(char j = 0; j < height; ++j)
+      writePixel(x + i, y + j, CANVAS_READ(&column[j / 4]) & (1 << (j % 4)), rop);
+  }
+}
+
+void HT1632Canvas::drawText(const char text [], int x, int y, const char font [], const char font_width [], char font_height, int font_glyph_step, char gutter_space, char rop) {
+  int curr_x = x;
+  int currchar;
+
+  if(y + font_height < 0 || y >= _height)
+    return;
+
+  for(int i = 0; text[i] != '\0' && curr_x < _width; ++i) {
+    currchar = text[i] - 32;
+    if(currchar >= 65 && currchar <= 90) // If character is lower-case, automatically make it upper-case
+      currchar -= 32;
+    if(currchar < 0 || currchar >= 64) // If out of bounds, skip
+      continue;
+
+    if(curr_x + font_width[currchar] + gutter_space >= 0) {
+      drawImage(font, font_width[currchar], font_height, curr_x, y, currchar * font_glyph_step, rop);
+      // The gutter is the first column of the space glyph, like in HT1632Class::drawText().
+      for(char j = 0; j < gutter_space; ++j)
+        drawImage(font, 1, font_height, curr_x + font_width[currchar] + j, y, 0, rop);
+    }
+    curr_x += font_width[currchar] + gutter_space;
+  }
+}
+
+// The 4 pixels of column starting at row y, in the layout of a display word (bit k is row y + k).
+//   Rows outside the canvas are blank.
+char HT1632Canvas::readWord(const unsigned char * column, int y) {
+  if(y >= 0 && y + 3 < _height) {
+    const int index = y / 8;
+    const char shift = y % 8;
+    unsigned int window = column[index];
+    if(shift > 4) // The word straddles two bytes.
+      window |= (unsigned int)column[index + 1] << 8;
+    return (window >> shift) & 0b00001111;
+  }
+
+  char data = 0;
+  for(char k = 0; k < 4; ++k)
+    if(y + k >= 0 && y + k < _height && (column[(y + k) / 8] & (1 << ((y + k) % 8))))
+      data |= 1 << k;
+  return data;
+}
+
+void HT1632Canvas::drawViewport(int vx, int vy, int x, int y, int width, int height) {
+  // Clip the rectangle to the display, moving the window with it.
+  if(x < 0) { vx -= x; if(width >= 0) width += x; x = 0; }
+  if(y < 0) { vy -= y; if(height >= 0) height += y; y = 0; }
+  if(width < 0 || x + width > HT1632.getWidth()) width = HT1632.getWidth() - x;
+  if(height < 0 || y + height > HT1632.getHeight()) height = HT1632.getHeight() - y;
+  if(width <= 0 || height <= 0)
+    return;
+
+  for(int i = 0; i < width; ++i) {
+    const int cx = vx + i;
+    const unsigned char * column = (cx >= 0 && cx < _width) ? &_bits[cx * _columnBytes] : 0;
+    // One whole display word at a time; only the words at the top and bottom of the rectangle
+    //   are masked.
+    for(int sy = y & ~3; sy < y + height; sy += 4) {
+      char mask = 0b00001111;
+      if(sy < y)
+        mask &= 0b00001111 << (y - sy);
+      if(sy + 4 > y + height)
+        mask &= 0b00001111 >> (sy + 4 - y - height);
+      const char data = column ? readWord(column, vy + sy - y) : 0;
+      HT1632.writeNibble(x + i, sy, mask, data);
+    }
+  }
+}
@@ -0,0 +1,50 @@
+/*
+  HT1632Canvas.h - Off-screen drawing surface for the HT1632 library,
+  larger than the display. Content is drawn into the canvas once, and
+  drawViewport() copies the window seen from a given position into the
+  current draw target. Only the words that actually change are flagged,
+  so panning across a long message or a map costs one bounded copy per
+  frame instead of a full redraw.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Canvas_h
+#define HT1632Canvas_h
+
+#include "HT1632.h"
+
+// Size in bytes of the buffer of a canvas. Pixels are packed 8 per byte, column by column.
+#define CANVAS_BYTES(width, height) ((width) * (((height) + 7) / 8))
+
+class HT1632Canvas
+{
+  private:
+    unsigned char * _bits;
+    int _width;
+    int _height;
+    int _columnBytes;
+    void writePixel(int x, int y, bool datum, char rop);
+    char readWord(const unsigned char * column, int y);
+
+  public:
+    // buffer must hold CANVAS_BYTES(width, height) bytes, and stay allocated while the canvas is used.
+    HT1632Canvas(unsigned char * buffer, int width, int height);
+    int getWidth();
+    int getHeight();
+    void clear();
+    void setPixel(int x, int y, bool datum = true);
+    bool getPixel(int x, int y);
+    // Same as the HT1632Class functions, but drawing into the canvas and clipping to its size.
+    void drawImage(const char * img, char width, char height, int x, int y, int offset = 0, char rop = ROP_COPY);
+    void drawText(const char [], int x, int y, const char font [], const char font_width [], char font_height,
+      int font_glyph_step, char gutter_space = 1, char rop = ROP_COPY);
+    // Copy the window of the canvas whose top-left corner is (vx, vy) into the rectangle of the
+    //   current draw target at (x, y), by default the whole draw target (a negative width or height
+    //   extends to its edge, which is all the boards in BUFFER_TILED). Parts of the window outside
+    //   the canvas are blank. Call render() afterwards.
+    void drawViewport(int vx, int vy, int x = 0, int y = 0, int width = -1, int height = -1);
+};
+
+#else
+//#error "HT1632Canvas.h" already defined!
+#endif
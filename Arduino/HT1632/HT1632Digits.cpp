@@ -0,0 +1,130 @@
+#include "HT1632Digits.h"
+
+#define DIGITS_HIDDEN 0x80
+
+HT1632Digits::HT1632Digits(int x, int y, const char font [], const char font_width [], char font_height,
+    int font_glyph_step, char gutter_space) {
+  _font = font;
+  _fontWidth = font_width;
+  _fontHeight = font_height;
+  _fontGlyphStep = font_glyph_step;
+  _gutter = gutter_space;
+  _digitWidth = 0;
+  for(char c = '0'; c <= '9'; ++c)
+    if(_fontWidth[glyphOf(c)] > _digitWidth)
+      _digitWidth = _fontWidth[glyphOf(c)];
+  setPosition(x, y);
+}
+
+void HT1632Digits::setPosition(int x, int y) {
+  _x = x;
+  _y = y;
+  invalidate();
+}
+
+void HT1632Digits::invalidate() {
+  _length = 0;
+  _end = _x;
+}
+
+int HT1632Digits::getWidth() {
+  return _end - _x;
+}
+
+// Glyph of c in the font, like in HT1632Class::drawText(). Characters that are not in the font are
+//   drawn as spaces.
+int HT1632Digits::glyphOf(char c) {
+  int glyph = (char)(c & ~DIGITS_HIDDEN) - 32;
+  if(glyph >= 65 && glyph <= 90) // Lower-case characters are drawn upper-case.
+    glyph -= 32;
+  return (glyph < 0 || glyph >= 64) ? 0 : glyph;
+}
+
+// Columns taken by c, including the gutter. Digits and spaces are all as wide as the widest digit.
+char HT1632Digits::cellWidth(char c) {
+  const char visible = c & ~DIGITS_HIDDEN;
+  if(visible == ' ' || (visible >= '0' && visible <= '9'))
+    return _digitWidth + _gutter;
+  return _fontWidth[glyphOf(c)] + _gutter;
+}
+
+// Draw c in its cell starting at column x, centered if it is narrower than the cell. The rest of
+//   the cell is blanked with the first column of the space glyph, like the gutter of drawText().
+void HT1632Digits::drawCell(int x, char c) {
+  const int glyph = (c & DIGITS_HIDDEN) ? 0 : glyphOf(c);
+  const char width = cellWidth(c);
+  const char glyphWidth = glyph ? _fontWidth[glyph] : 0;
+  const char left = (width - _gutter - glyphWidth) / 2;
+
+  for(char i = 0; i < width; ++i)
+    if(i < left || i >= left + glyphWidth)
+      HT1632.drawImage(_font, 1, _fontHeight, x + i, _y, 0);
+  if(glyphWidth)
+    HT1632.drawImage(_font, glyphWidth, _fontHeight, x + left, _y, glyph * _fontGlyphStep);
+}
+
+// Once a character changes width, every character after it moves, so it is redrawn too.
+bool HT1632Digits::update(const char text [], int length) {
+  if(length > DIGITS_MAX_CHARS)
+    length = DIGITS_MAX_CHARS;
+
+  bool changed = false;
+  bool moved = false;
+  int x = _x;
+  for(int i = 0; i < length; ++i) {
+    const char width = cellWidth(text[i]);
+    if(moved || i >= _length || text[i] != _text[i]) {
+      moved |= i >= _length || width != cellWidth(_text[i]);
+      drawCell(x, text[i]);
+      _text[i] = text[i];
+      changed = true;
+    }
+    x += width;
+  }
+
+  // Blank what is left of a longer text.
+  for(int i = x; i < _end; ++i) {
+    HT1632.drawImage(_font, 1, _fontHeight, i, _y, 0);
+    changed = true;
+  }
+  _length = length;
+  _end = x;
+  return changed;
+}
+
+bool HT1632Digits::print(const char text []) {
+  int length = 0;
+  while(length < DIGITS_MAX_CHARS && text[length] != '\0')
+    ++length;
+  return update(text, length);
+}
+
+bool HT1632Digits::printNumber(long value, char digits, char pad) {
+  char text [DIGITS_MAX_CHARS];
+  int i = DIGITS_MAX_CHARS;
+  const bool negative = value < 0;
+  unsigned long n = negative ? 0UL - (unsigned long)value : value;
+
+  // Fill from the right.
+  do {
+    text[--i] = '0' + n % 10;
+    n /= 10;
+  } while(n != 0 && i > 1);
+  if(negative && pad != '0')
+    text[--i] = '-';
+  while(DIGITS_MAX_CHARS - i < digits - ((negative && pad == '0') ? 1 : 0) && i > 1)
+    text[--i] = pad;
+  if(negative && pad == '0')
+    text[--i] = '-';
+  return update(&text[i], DIGITS_MAX_CHARS - i);
+}
+
+bool HT1632Digits::printTime(char hours, char minutes, char seconds, bool colon) {
+  const char separator = colon ? ':' : (char)(':' | DIGITS_HIDDEN);
+  char text [8] = {
+    (char)('0' + hours / 10), (char)('0' + hours % 10), separator,
+    (char)('0' + minutes / 10), (char)('0' + minutes % 10), separator,
+    (char)('0' + seconds / 10), (char)('0' + seconds % 10)
+  };
+  return update(text, (seconds < 0) ? 5 : 8);
+}
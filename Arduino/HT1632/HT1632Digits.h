@@ -0,0 +1,59 @@
+/*
+  HT1632Digits.h - Counter and clock widget for the HT1632 library.
+  Remembers the characters it last drew and where, and only redraws the
+  glyphs that changed, so a clock ticking from 12:34:56 to 12:34:57 only
+  touches the last digit. Digits (and blanks) are given the width of the
+  widest digit of the font, so the other glyphs never move.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Digits_h
+#define HT1632Digits_h
+
+#include "HT1632.h"
+
+// Maximum number of characters in a widget, enough for any long.
+#define DIGITS_MAX_CHARS 12
+
+class HT1632Digits
+{
+  private:
+    const char * _font;
+    const char * _fontWidth;
+    char _fontHeight;
+    int _fontGlyphStep;
+    char _gutter;
+    char _digitWidth; // Widest digit of the font
+    int _x;
+    int _y;
+    // Characters on screen; bit 7 is set for the characters that are hidden (drawn blank).
+    char _text [DIGITS_MAX_CHARS];
+    char _length;
+    int _end;         // First column after the characters on screen
+    int glyphOf(char c);
+    char cellWidth(char c);
+    void drawCell(int x, char c);
+    bool update(const char text [], int length);
+
+  public:
+    HT1632Digits(int x, int y, const char font [], const char font_width [], char font_height,
+      int font_glyph_step, char gutter_space = 1);
+    // Move the widget. The old position is not erased.
+    void setPosition(int x, int y);
+    // Draw everything at the next update, for example after clear() or after drawing over the widget.
+    void invalidate();
+    // Width of the characters on screen, in columns.
+    int getWidth();
+    // Show text, redrawing only the characters that differ from what is on screen. Returns true if
+    //   the current draw target changed, in which case render() should be called.
+    bool print(const char text []);
+    // Show value right-aligned in at least digits characters, padded with pad (' ' or '0').
+    bool printNumber(long value, char digits = 0, char pad = ' ');
+    // Show HH:MM, or HH:MM:SS if seconds is not negative. With colon unset, the colons are blank but
+    //   keep their width, for a blinking separator.
+    bool printTime(char hours, char minutes, char seconds = -1, bool colon = true);
+};
+
+#else
+//#error "HT1632Digits.h" already defined!
+#endif
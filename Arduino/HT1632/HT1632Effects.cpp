@@ -0,0 +1,220 @@
+#include "HT1632Effects.h"
+
+#ifdef RASPBERRY_PI
+
+#include <string.h>
+#define PROGMEM
+#define EFFECTS_READ(p) (*(const unsigned char *)(p))
+
+#else // ifdef RASPBERRY_PI
+
+#if (ARDUINO >= 100)
+  #include <Arduino.h>
+#else
+  #include <WProgram.h>
+#endif
+#define EFFECTS_READ(p) ((unsigned char)pgm_read_byte(p))
+
+#endif // ifdef RASPBERRY_PI
+
+// One period of a sine wave, between 1 and 255.
+const unsigned char EFFECTS_SINE [64] PROGMEM = {
+  128, 140, 153, 165, 177, 188, 199, 209, 218, 226, 234, 240, 245, 250, 253, 254,
+  255, 254, 253, 250, 245, 240, 234, 226, 218, 209, 199, 188, 177, 165, 153, 140,
+  128, 116, 103, 91, 79, 68, 57, 47, 38, 30, 22, 16, 11, 6, 3, 2,
+  1, 2, 3, 6, 11, 16, 22, 30, 38, 47, 57, 68, 79, 91, 103, 116,
+};
+
+// angle is in 1/256th of a turn.
+static unsigned char sine(unsigned char angle) {
+  return EFFECTS_READ(&EFFECTS_SINE[angle >> 2]);
+}
+
+// Xorshift, so that the effects are repeatable and the same on every platform.
+static unsigned long nextRandom(unsigned long & state) {
+  state ^= (state << 13) & 0xFFFFFFFFUL;
+  state ^= state >> 17;
+  state ^= (state << 5) & 0xFFFFFFFFUL;
+  return state;
+}
+
+HT1632Bitplane::HT1632Bitplane(unsigned long * columns, int width, char height) {
+  if(height > BITPLANE_MAX_HEIGHT)
+    height = BITPLANE_MAX_HEIGHT;
+  _columns = columns;
+  _width = width;
+  _height = height;
+  _mask = (height == BITPLANE_MAX_HEIGHT) ? 0xFFFFFFFFUL : (1UL << height) - 1;
+}
+
+int HT1632Bitplane::getWidth() {
+  return _width;
+}
+
+char HT1632Bitplane::getHeight() {
+  return _height;
+}
+
+void HT1632Bitplane::clear() {
+  memset(_columns, 0, _width * sizeof(unsigned long));
+}
+
+void HT1632Bitplane::setPixel(int x, int y, bool datum) {
+  if(x < 0 || x >= _width || y < 0 || y >= _height)
+    return;
+  if(datum)
+    _columns[x] |= 1UL << y;
+  else
+    _columns[x] &= ~(1UL << y);
+}
+
+bool HT1632Bitplane::getPixel(int x, int y) {
+  if(x < 0 || x >= _width || y < 0 || y >= _height)
+    return false;
+  return (_columns[x] >> y) & 1;
+}
+
+void HT1632Bitplane::randomize(unsigned long seed) {
+  if(seed == 0)
+    seed = 1; // Xorshift never leaves 0.
+  for(int i = 0; i < _width; ++i) {
+    const unsigned long a = nextRandom(seed);
+    const unsigned long b = nextRandom(seed);
+    const unsigned long c = nextRandom(seed);
+    _columns[i] = a & (b | c) & _mask; // Probability 1/2 * 3/4.
+  }
+}
+
+// Number of set pixels among each row of column and the rows just above and below it, as 2-bit
+//   numbers bit-sliced into lo and hi: bit k of lo and hi is the count for row k.
+void HT1632Bitplane::columnSum(unsigned long column, bool wrap, unsigned long & lo, unsigned long & hi) {
+  unsigned long above = column << 1; // Bit k is row k - 1.
+  unsigned long below = column >> 1; // Bit k is row k + 1.
+  if(wrap) {
+    above |= column >> (_height - 1);
+    below |= column << (_height - 1);
+  }
+  above &= _mask;
+  below &= _mask;
+  // Full adder.
+  lo = above ^ column ^ below;
+  hi = (above & column) | (below & (above ^ column));
+}
+
+// Each cell is counted together with its 8 neighbours, by adding the vertical sums of the column
+//   and of the columns on each side. With the cell itself included, a total of 3 means a birth or a
+//   survival, and a total of 4 means that a live cell survives.
+bool HT1632Bitplane::lifeStep(bool wrap) {
+  if(_width <= 0)
+    return false;
+
+  unsigned long prevLo = 0, prevHi = 0, currLo, currHi, nextLo = 0, nextHi = 0;
+  columnSum(_columns[0], wrap, currLo, currHi);
+  // The columns are updated in place, so the sums of the first one are kept for the last one.
+  const unsigned long firstLo = currLo, firstHi = currHi;
+  if(wrap)
+    columnSum(_columns[_width - 1], wrap, prevLo, prevHi);
+
+  bool changed = false;
+  for(int i = 0; i < _width; ++i) {
+    if(i + 1 < _width)
+      columnSum(_columns[i + 1], wrap, nextLo, nextHi);
+    else if(wrap) {
+      nextLo = firstLo;
+      nextHi = firstHi;
+    } else
+      nextLo = nextHi = 0;
+
+    // Add the three 2-bit sums into the 4-bit total s3 s2 s1 s0.
+    const unsigned long s0 = prevLo ^ currLo ^ nextLo;
+    const unsigned long c0 = (prevLo & currLo) | (nextLo & (prevLo ^ currLo));
+    const unsigned long h  = prevHi ^ currHi ^ nextHi;
+    const unsigned long c1 = (prevHi & currHi) | (nextHi & (prevHi ^ currHi));
+    const unsigned long s1 = h ^ c0;
+    const unsigned long c2 = h & c0;
+    const unsigned long s2 = c1 ^ c2;
+    const unsigned long s3 = c1 & c2;
+
+    const unsigned long alive = _columns[i];
+    const unsigned long next = ~s3 & ((s0 & s1 & ~s2) | (alive & ~s0 & ~s1 & s2));
+    changed |= next != alive;
+    _columns[i] = next;
+
+    prevLo = currLo; prevHi = currHi;
+    currLo = nextLo; currHi = nextHi;
+  }
+  return changed;
+}
+
+// The plasma is the average of a vertical, a horizontal and (with twice the weight) a diagonal
+//   wave, each moving at its own speed. The first two only depend on the row or the column.
+void HT1632Bitplane::plasma(unsigned int time, int low, int high) {
+  unsigned char rowWave [BITPLANE_MAX_HEIGHT];
+  for(int j = 0; j < _height; ++j)
+    rowWave[j] = sine(j * 23 + time * 2);
+
+  for(int i = 0; i < _width; ++i) {
+    const int columnWave = sine(i * 13 + time);
+    unsigned long column = 0;
+    for(int j = 0; j < _height; ++j) {
+      const int value = (columnWave + rowWave[j] + 2 * sine((i + j) * 9 - time * 3)) / 4;
+      if(value >= low && value < high)
+        column |= 1UL << j;
+    }
+    _columns[i] = column;
+  }
+}
+
+void HT1632Bitplane::draw(int x, int y, char rop) {
+  int x_end = x + _width;
+  int y_end = y + _height;
+  if(x_end > HT1632.getWidth()) x_end = HT1632.getWidth();
+  if(y_end > HT1632.getHeight()) y_end = HT1632.getHeight();
+
+  for(int px = (x < 0) ? 0 : x; px < x_end; ++px) {
+    const unsigned long column = _columns[px - x];
+    // One whole display word at a time; only the words at the top and bottom of the plane are masked.
+    for(int sy = ((y < 0) ? 0 : y) & ~3; sy < y_end; sy += 4) {
+      char mask = 0b00001111;
+      if(sy < y)
+        mask &= 0b00001111 << (y - sy);
+      if(sy + 4 > y_end)
+        mask &= 0b00001111 >> (sy + 4 - y_end);
+      const int row = sy - y; // Row of the plane shown in the first row of the word.
+      const char data = ((row >= 0) ? column >> row : column << -row) & mask;
+      HT1632.writeNibble(px, sy, mask, data, rop);
+    }
+  }
+}
+
+HT1632Starfield::HT1632Starfield(char numStars, unsigned long seed) {
+  _numStars = (numStars > MAX_STARS) ? MAX_STARS : numStars;
+  _seed = (seed == 0) ? 1 : seed;
+  _started = false;
+}
+
+// Place star at the right edge of plane, or anywhere on it when the starfield starts.
+void HT1632Starfield::spawn(Star & star, HT1632Bitplane & plane, bool anywhere) {
+  const unsigned long r = nextRandom(_seed);
+  star.x = anywhere ? (int)(r % (plane.getWidth() * 16)) : plane.getWidth() * 16 - 1;
+  star.y = (r >> 16) % plane.getHeight();
+  star.speed = 4 + (r >> 24) % 13; // A quarter of a pixel to a pixel per step.
+}
+
+void HT1632Starfield::step(HT1632Bitplane & plane) {
+  for(int k = 0; k < _numStars; ++k) {
+    Star & star = _stars[k];
+    if(!_started)
+      spawn(star, plane, true);
+    else if((star.x -= star.speed) < 0)
+      spawn(star, plane, false);
+  }
+  _started = true;
+
+  plane.clear();
+  for(int k = 0; k < _numStars; ++k) {
+    plane.setPixel(_stars[k].x / 16, _stars[k].y);
+    if(_stars[k].speed > 12)
+      plane.setPixel(_stars[k].x / 16 + 1, _stars[k].y);
+  }
+}
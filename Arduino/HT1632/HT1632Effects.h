@@ -0,0 +1,77 @@
+/*
+  HT1632Effects.h - Procedural effects for the HT1632 library, such as
+  attract-mode animations for idle signs. Effects work on a bitplane, a
+  packed 1-bit image stored as one word per column, with bit k holding
+  row k. Whole columns are computed at once with word-wide bit operations
+  (the Game of Life counts the neighbours of every cell of a column in
+  parallel with bit-sliced adders), and draw() converts the result into
+  display words, so that only the words that changed are rendered.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Effects_h
+#define HT1632Effects_h
+
+#include "HT1632.h"
+
+// A column of a bitplane fits in an unsigned long.
+#define BITPLANE_MAX_HEIGHT 32
+
+// Maximum number of stars in a starfield. Each star uses 4 bytes of RAM.
+#define MAX_STARS 24
+
+class HT1632Bitplane
+{
+  private:
+    unsigned long * _columns;
+    int _width;
+    char _height;
+    unsigned long _mask; // Bits of a column that are rows of the plane.
+    void columnSum(unsigned long column, bool wrap, unsigned long & lo, unsigned long & hi);
+
+  public:
+    // columns must hold width words, and stay allocated while the bitplane is used.
+    HT1632Bitplane(unsigned long * columns, int width, char height);
+    int getWidth();
+    char getHeight();
+    void clear();
+    void setPixel(int x, int y, bool datum = true);
+    bool getPixel(int x, int y);
+    // Fill the plane with noise, about 3 pixels in 8 set, which is a good start for lifeStep().
+    //   The same seed always gives the same pattern.
+    void randomize(unsigned long seed);
+    // Advance Conway's Game of Life by one generation, with the edges wrapping around if wrap is
+    //   set. Returns false if the pattern did not change, for example to reseed a dead board.
+    bool lifeStep(bool wrap = true);
+    // Set the pixels where the plasma value (0 to 255) at the given time is at least low and below
+    //   high, and clear the others. On bicolor boards, overlapping bands in two planes give orange.
+    void plasma(unsigned int time, int low, int high = 256);
+    // Draw the plane into the current draw target with its top-left corner at (x, y), clipped to
+    //   the target. Call render() afterwards.
+    void draw(int x = 0, int y = 0, char rop = ROP_COPY);
+};
+
+// Stars scrolling from right to left at different speeds, the faster ones leaving a short trail.
+class HT1632Starfield
+{
+  private:
+    struct Star {
+      int x;      // In 1/16th of a pixel.
+      char y;
+      char speed; // In 1/16th of a pixel per step.
+    };
+    Star _stars [MAX_STARS];
+    char _numStars;
+    bool _started;
+    unsigned long _seed;
+    void spawn(Star & star, HT1632Bitplane & plane, bool anywhere);
+
+  public:
+    HT1632Starfield(char numStars = MAX_STARS, unsigned long seed = 1);
+    // Move the stars one step, and draw them into plane, which is cleared first.
+    void step(HT1632Bitplane & plane);
+};
+
+#else
+//#error "HT1632Effects.h" already defined!
+#endif
@@ -0,0 +1,88 @@
+#include "HT1632FrameRate.h"
+
+#ifdef RASPBERRY_PI
+  #include <wiringPi.h>
+#else
+#if (ARDUINO >= 100)
+  #include <Arduino.h>
+#else
+  #include <WProgram.h>
+#endif
+#endif // ifdef RASPBERRY_PI
+
+HT1632FrameScheduler::HT1632FrameScheduler(unsigned int fps) {
+  setFrameRate(fps);
+  _frames = 0;
+  _missed = 0;
+  _dropped = 0;
+  _busy = 0;
+  _started = false;
+}
+
+void HT1632FrameScheduler::setFrameRate(unsigned int fps) {
+  if(fps < 1)
+    fps = 1;
+  _period = 1000000UL / fps;
+}
+
+void HT1632FrameScheduler::reset() {
+  _started = false;
+}
+
+unsigned int HT1632FrameScheduler::waitForFrame() {
+  unsigned long now = micros();
+
+  if(!_started) {
+    _started = true;
+    _next = now + _period;
+    _frameStart = now;
+    ++_frames;
+    return 1;
+  }
+
+  _busy = now - _frameStart;
+  unsigned int steps = 1;
+  long late = (long)(now - _next);
+
+  if(late <= 0) {
+    // On time: sleep for the rest of the frame. delayMicroseconds() is only accurate for short
+    //   delays, so the bulk is slept with delay().
+    unsigned long remaining = (unsigned long)(-late);
+    if(remaining >= 1000)
+      delay(remaining / 1000);
+    delayMicroseconds(remaining % 1000);
+    _next += _period;
+  } else {
+    // Late: merge every frame whose deadline already passed into this one, and keep the
+    //   schedule aligned on the original grid so the pace stays the same on average.
+    ++_missed;
+    unsigned long skipped = (unsigned long)late / _period;
+    _dropped += skipped;
+    steps += skipped;
+    _next += (skipped + 1) * _period;
+  }
+
+  _frameStart = micros();
+  ++_frames;
+  return steps;
+}
+
+unsigned long HT1632FrameScheduler::getBusyMicros() {
+  return _busy;
+}
+
+unsigned long HT1632FrameScheduler::getFramePeriod() {
+  return _period;
+}
+
+unsigned long HT1632FrameScheduler::getFrames() {
+  return _frames;
+}
+
+unsigned long HT1632FrameScheduler::getMissedFrames() {
+  return _missed;
+}
+
+unsigned long HT1632FrameScheduler::getDroppedFrames() {
+  return _dropped;
+}
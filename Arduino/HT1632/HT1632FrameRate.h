@@ -0,0 +1,50 @@
+/*
+  HT1632FrameRate.h - Frame scheduler for the HT1632 library.
+  Replaces a fixed delay() at the end of loop(): waitForFrame() only
+  sleeps for what is left of the frame after drawing and rendering, so
+  animations and scrolling text keep the same speed whatever the content.
+  When a frame takes too long, the following frames are merged into one
+  and the sketch is told how many steps to advance.
+
+  Released into the public domain.
+*/
+#ifndef HT1632FrameRate_h
+#define HT1632FrameRate_h
+
+class HT1632FrameScheduler
+{
+  private:
+    unsigned long _period;     // Frame period, in microseconds
+    unsigned long _next;       // Deadline of the current frame
+    unsigned long _frameStart;
+    unsigned long _busy;
+    unsigned long _frames;
+    unsigned long _missed;
+    unsigned long _dropped;
+    bool _started;
+
+  public:
+    HT1632FrameScheduler(unsigned int fps = 30);
+    // Change the target frame rate. Takes effect at the next frame.
+    void setFrameRate(unsigned int fps);
+    // Sleep until the current frame is due. Returns the number of frame periods that elapsed since
+    //   the previous call: 1 when on time, more when the previous frame missed its deadline, in
+    //   which case the late frames are merged and the sketch should advance by that many steps.
+    //   The first call returns immediately.
+    unsigned int waitForFrame();
+    // Restart the schedule from now, e.g. after a blocking transition().
+    void reset();
+    // Time spent between the two previous calls to waitForFrame(), excluding the sleep, in
+    //   microseconds. Compare with getFramePeriod() to see how much headroom is left.
+    unsigned long getBusyMicros();
+    unsigned long getFramePeriod();
+    unsigned long getFrames();
+    // Frames that finished after their deadline.
+    unsigned long getMissedFrames();
+    // Frames that were merged into a late frame instead of being drawn.
+    unsigned long getDroppedFrames();
+};
+
+#else
+//#error "HT1632FrameRate.h" already defined!
+#endif
@@ -0,0 +1,131 @@
+#include "HT1632Receiver.h"
+
+#define STREAM_WORDS (OUT_SIZE * COM_SIZE / 4)
+#define STREAM_ROWS  (COM_SIZE / 4)
+
+// Decoder states
+#define STATE_SYNC      0
+#define STATE_TYPE      1
+#define STATE_BUFFER    2
+#define STATE_LENGTH_LO 3
+#define STATE_LENGTH_HI 4
+#define STATE_SKIP      5 // Delta payload: start of a run
+#define STATE_COUNT     6 // Delta payload: number of words in the run
+#define STATE_WORDS     7 // Packed words
+#define STATE_CHECKSUM  8
+
+HT1632Receiver::HT1632Receiver() {
+  reset();
+}
+
+void HT1632Receiver::reset() {
+  _state = STATE_SYNC;
+}
+
+char HT1632Receiver::feed(unsigned char b) {
+  switch(_state) {
+    case STATE_SYNC:
+      if(b == STREAM_SYNC) {
+        _checksum = 0;
+        _state = STATE_TYPE;
+      }
+      return STREAM_BUSY;
+
+    case STATE_TYPE:
+      _type = b;
+      _valid = (b == STREAM_FRAME_FULL || b == STREAM_FRAME_DELTA);
+      _state = STATE_BUFFER;
+      break;
+
+    case STATE_BUFFER:
+      _buffer = b;
+      HT1632.drawTarget(b);
+      _valid = _valid && (HT1632._tgtBuffer == _buffer);
+      _state = STATE_LENGTH_LO;
+      break;
+
+    case STATE_LENGTH_LO:
+      _length = b;
+      _state = STATE_LENGTH_HI;
+      break;
+
+    case STATE_LENGTH_HI:
+      _length |= (unsigned int)b << 8;
+      _remaining = _length;
+      _word = 0;
+      _runWords = 0;
+      if(_type == STREAM_FRAME_FULL) {
+        _valid = _valid && (_length == STREAM_WORDS / 2);
+        _state = STATE_WORDS;
+      } else {
+        _state = STATE_SKIP;
+      }
+      if(_remaining == 0)
+        _state = STATE_CHECKSUM;
+      break;
+
+    case STATE_SKIP:
+    case STATE_COUNT:
+    case STATE_WORDS:
+      _checksum ^= b;
+      payload(b);
+      if(--_remaining == 0) {
+        // A delta must end on a run boundary, and a full frame must have covered every word.
+        if(_type == STREAM_FRAME_FULL ? _word != STREAM_WORDS : _state != STATE_SKIP)
+          _valid = false;
+        _state = STATE_CHECKSUM;
+      }
+      return STREAM_BUSY;
+
+    case STATE_CHECKSUM:
+      _state = STATE_SYNC;
+      if(b != _checksum || !_valid)
+        return STREAM_ERROR;
+      HT1632.render();
+      return STREAM_DONE;
+  }
+  _checksum ^= b;
+  return STREAM_BUSY;
+}
+
+void HT1632Receiver::payload(unsigned char b) {
+  switch(_state) {
+    case STATE_SKIP:
+      _word += b;
+      _state = STATE_COUNT;
+      return;
+
+    case STATE_COUNT:
+      _runWords = b;
+      _state = (b == 0) ? STATE_SKIP : STATE_WORDS;
+      return;
+
+    default: // STATE_WORDS
+      if(_type == STREAM_FRAME_FULL) {
+        writeWord(b >> 4, ROP_COPY);
+        writeWord(b, ROP_COPY);
+        return;
+      }
+      writeWord(b >> 4, ROP_XOR);
+      if(--_runWords > 0) {
+        writeWord(b, ROP_XOR);
+        --_runWords;
+      }
+      if(_runWords == 0)
+        _state = STATE_SKIP;
+      return;
+  }
+}
+
+// Write the next word of the buffer. Words past the end of the buffer invalidate the packet, and
+//   nothing is written for packets that are already known to be invalid.
+void HT1632Receiver::writeWord(char data, char rop) {
+  if(_word >= STREAM_WORDS) {
+    _valid = false;
+    return;
+  }
+  // Streams carry the contents of the buffer, so the orientation does not apply.
+  if(_valid)
+    HT1632.writeCell(HT1632.cellAt(_word / STREAM_ROWS, (_word % STREAM_ROWS) * 4), 0b00001111, data, rop);
+  ++_word;
+}
@@ -0,0 +1,67 @@
+/*
+  HT1632Receiver.h - Decoder for frames streamed to the HT1632 library
+  from a host, e.g. over Serial. Bytes are fed one at a time as they
+  arrive, and decoded straight into the board buffers: only the words that
+  actually change are flagged, so the render() at the end of each frame
+  only sends those. See "Utilities/Serial streaming/" for the host side.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Receiver_h
+#define HT1632Receiver_h
+
+#include "HT1632.h"
+
+// Stream format
+// A frame is sent as a packet:
+//   STREAM_SYNC, type, buffer, payload length (low byte, high byte), payload, checksum
+// where buffer is the render buffer to draw into (BUFFER_BOARD(n)), and checksum is the XOR of
+//   every byte between STREAM_SYNC and the checksum.
+// The payload describes the 4-bit words of the buffer in the same order as the images of
+//   drawImage(): column by column, COM_SIZE/4 words per column. Words are packed two per byte,
+//   the first one in the high nibble.
+//   STREAM_FRAME_FULL:  every word of the buffer.
+//   STREAM_FRAME_DELTA: runs of (number of words to skip, number of words n, then n words packed
+//                       two per byte). The words are XORed into the buffer, so only the words
+//                       that differ from the previous frame are sent.
+// After each packet, the receiver should answer STREAM_ACK, or STREAM_NAK if the packet was
+//   corrupted. After a NAK, the buffer contents are unknown and the host should send a full frame.
+#define STREAM_SYNC        0xA5
+#define STREAM_FRAME_FULL  0x01
+#define STREAM_FRAME_DELTA 0x02
+#define STREAM_ACK         0x06
+#define STREAM_NAK         0x15
+
+// Results of HT1632Receiver::feed()
+#define STREAM_BUSY  0x00 // Packet not complete yet
+#define STREAM_DONE  0x01 // Packet decoded and rendered
+#define STREAM_ERROR 0x02 // Packet rejected
+
+class HT1632Receiver
+{
+  private:
+    char _state;
+    char _type;
+    char _buffer;
+    unsigned char _checksum;
+    unsigned int _length;
+    unsigned int _remaining;   // Payload bytes left
+    unsigned int _word;        // Index of the next word in the buffer
+    unsigned char _runWords;   // Words left in the current delta run
+    bool _valid;
+    void writeWord(char data, char rop);
+    void payload(unsigned char b);
+
+  public:
+    HT1632Receiver();
+    // Decode one byte of the stream. Returns STREAM_DONE once a packet has been decoded into its
+    //   buffer and rendered, STREAM_ERROR if it was corrupted, and STREAM_BUSY otherwise.
+    //   Leaves the draw target set to the buffer of the last packet.
+    char feed(unsigned char b);
+    // Drop any partial packet, e.g. after a timeout.
+    void reset();
+};
+
+#else
+//#error "HT1632Receiver.h" already defined!
+#endif
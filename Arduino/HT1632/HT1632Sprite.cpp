@@ -0,0 +1,161 @@
+#include "HT1632Sprite.h"
+
+#ifndef RASPBERRY_PI
+#if (ARDUINO >= 100)
+  #include <Arduino.h>
+#else
+  #include <WProgram.h>
+#endif
+#endif // ifndef RASPBERRY_PI
+
+struct SpriteRect {
+  int x, y, width, height;
+};
+
+static bool intersects(const SpriteRect & a, int x, int y, int width, int height) {
+  return a.x < x + width && x < a.x + a.width && a.y < y + height && y < a.y + a.height;
+}
+
+HT1632SpriteLayer::HT1632SpriteLayer(char backgroundBuffer) {
+  _numSprites = 0;
+  _background = backgroundBuffer;
+  _invalidated = true;
+}
+
+int HT1632SpriteLayer::add(const char * img, char width, char height, int x, int y, char z, char rop) {
+  if(_numSprites >= MAX_SPRITES)
+    return -1;
+
+  const int id = _numSprites++;
+  Sprite & s = _sprites[id];
+  s.img = img;
+  s.width = width;
+  s.height = height;
+  s.z = z;
+  s.rop = rop;
+  s.x = x;
+  s.y = y;
+  s.visible = true;
+  s.changed = true;
+  s.wasVisible = false;
+
+  // Keep _order sorted by z. Sprites with the same z are drawn in the order they were added.
+  int k = id;
+  for(; k > 0 && _sprites[_order[k-1]].z > z; --k)
+    _order[k] = _order[k-1];
+  _order[k] = id;
+  return id;
+}
+
+void HT1632SpriteLayer::move(int id, int x, int y) {
+  if(id < 0 || id >= _numSprites)
+    return;
+  Sprite & s = _sprites[id];
+  if(s.x != x || s.y != y) {
+    s.x = x;
+    s.y = y;
+    s.changed = true;
+  }
+}
+
+void HT1632SpriteLayer::setImage(int id, const char * img) {
+  if(id < 0 || id >= _numSprites)
+    return;
+  setImage(id, img, _sprites[id].width, _sprites[id].height);
+}
+
+void HT1632SpriteLayer::setImage(int id, const char * img, char width, char height) {
+  if(id < 0 || id >= _numSprites)
+    return;
+  Sprite & s = _sprites[id];
+  if(s.img != img || s.width != width || s.height != height) {
+    s.img = img;
+    s.width = width;
+    s.height = height;
+    s.changed = true;
+  }
+}
+
+void HT1632SpriteLayer::setVisible(int id, bool visible) {
+  if(id < 0 || id >= _numSprites)
+    return;
+  Sprite & s = _sprites[id];
+  if(s.visible != visible) {
+    s.visible = visible;
+    s.changed = true;
+  }
+}
+
+void HT1632SpriteLayer::invalidate() {
+  _invalidated = true;
+}
+
+void HT1632SpriteLayer::update() {
+  // Rectangles to restore from the background: the old and new place of every changed sprite,
+  //   plus the place of every sprite that has to be redrawn because it overlaps one of those.
+  SpriteRect dirty [3 * MAX_SPRITES];
+  bool redraw [MAX_SPRITES];
+  int numDirty = 0;
+
+  if(_invalidated) {
+    SpriteRect & r = dirty[numDirty++];
+    r.x = 0; r.y = 0; r.width = HT1632.getWidth(); r.height = HT1632.getHeight();
+  }
+
+  for(int i = 0; i < _numSprites; ++i) {
+    Sprite & s = _sprites[i];
+    redraw[i] = false;
+    if(!s.changed)
+      continue;
+    if(s.wasVisible) {
+      SpriteRect & r = dirty[numDirty++];
+      r.x = s.drawnX; r.y = s.drawnY; r.width = s.drawnWidth; r.height = s.drawnHeight;
+    }
+    if(s.visible) {
+      SpriteRect & r = dirty[numDirty++];
+      r.x = s.x; r.y = s.y; r.width = s.width; r.height = s.height;
+      redraw[i] = true;
+    }
+  }
+  if(numDirty == 0)
+    return;
+
+  // Unchanged sprites that overlap a dirty rectangle are redrawn as well. Their whole rectangle is
+  //   restored, so that opaque sprites can't leak over the ones above them.
+  bool grew = true;
+  while(grew) {
+    grew = false;
+    for(int i = 0; i < _numSprites; ++i) {
+      Sprite & s = _sprites[i];
+      if(redraw[i] || !s.visible)
+        continue;
+      for(int k = 0; k < numDirty; ++k) {
+        if(intersects(dirty[k], s.x, s.y, s.width, s.height)) {
+          SpriteRect & r = dirty[numDirty++];
+          r.x = s.x; r.y = s.y; r.width = s.width; r.height = s.height;
+          redraw[i] = true;
+          grew = true;
+          break;
+        }
+      }
+    }
+  }
+
+  for(int k = 0; k < numDirty; ++k)
+    HT1632.copyRegion(_background, dirty[k].x, dirty[k].y, dirty[k].width, dirty[k].height);
+
+  for(int k = 0; k < _numSprites; ++k) {
+    const int i = _order[k];
+    Sprite & s = _sprites[i];
+    if(redraw[i]) {
+      HT1632.drawImage(s.img, s.width, s.height, s.x, s.y, 0, s.rop);
+      s.drawnX = s.x;
+      s.drawnY = s.y;
+      s.drawnWidth = s.width;
+      s.drawnHeight = s.height;
+    }
+    s.wasVisible = s.visible;
+    s.changed = false;
+  }
+  _invalidated = false;
+}
@@ -0,0 +1,62 @@
+/*
+  HT1632Sprite.h - Sprite layer for the HT1632 library.
+  Keeps a static background in a separate buffer (BUFFER_SECONDARY by
+  default) and composites a small number of sprites over it. Each call to
+  update() only restores and redraws the rectangles that sprites left or
+  entered, so the following render() only sends those regions.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Sprite_h
+#define HT1632Sprite_h
+
+#include "HT1632.h"
+
+// Maximum number of sprites in a layer. Each sprite uses about 20 bytes of RAM.
+#define MAX_SPRITES 8
+
+class HT1632SpriteLayer
+{
+  private:
+    struct Sprite {
+      const char * img;
+      char width;
+      char height;
+      char z;
+      char rop;
+      int x;
+      int y;
+      bool visible;
+      bool changed;
+      // Where the sprite was last composited, valid if wasVisible.
+      bool wasVisible;
+      int drawnX;
+      int drawnY;
+      char drawnWidth;
+      char drawnHeight;
+    };
+    Sprite _sprites [MAX_SPRITES];
+    unsigned char _order [MAX_SPRITES]; // Sprite ids, sorted by increasing z.
+    char _numSprites;
+    char _background;
+    bool _invalidated;
+
+  public:
+    HT1632SpriteLayer(char backgroundBuffer = BUFFER_SECONDARY);
+    // Returns the id of the new sprite, or -1 if the layer is full. Sprites with a higher z are
+    //   drawn on top. The default ROP_OR makes unset pixels transparent; ROP_COPY makes the whole
+    //   rectangle of the sprite opaque.
+    int add(const char * img, char width, char height, int x, int y, char z = 0, char rop = ROP_OR);
+    void move(int id, int x, int y);
+    void setImage(int id, const char * img);
+    void setImage(int id, const char * img, char width, char height);
+    void setVisible(int id, bool visible);
+    // Force a full redraw, e.g. after the background was changed.
+    void invalidate();
+    // Composite all changes into the current draw target. Call render() afterwards.
+    void update();
+};
+
+#else
+//#error "HT1632Sprite.h" already defined!
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Microbenchmarks for the drawing and render paths of the HT1632 library.
+ * Prints, for every operation, the CPU time per call and the number of bits
+ * sent to the chips per call. Run it before and after a change to the
+ * library, with the same wiring and the same NUM_OF_BICOLOR_UNITS.
+ *
+ * Uncomment HT1632_STATS in HT1632.h to get the bit counts. Tests/benchmark.cpp
+ * runs the same benchmark on a computer, with a simulated bus.
+ */
+#include <font_5x4.h>
+#include <font_7x5.h>
+#include <font_8x4.h>
+#include <font_8x6.h>
+#include <font_16x8.h>
+#include <HT1632.h>
+#include <images.h>
+
+#define ITERATIONS 50
+
+const char text [] = "Hello, how are you?";
+
+unsigned long startTime;
+unsigned long startBits;
+
+void begin_op() {
+#ifdef HT1632_STATS
+  startBits = HT1632.getStats().wireBits;
+#endif
+  startTime = micros();
+}
+
+void end_op(const char * name, int calls) {
+  unsigned long elapsed = micros() - startTime;
+  Serial.print(name);
+  Serial.print('\t');
+  Serial.print(elapsed * 1000.0 / calls, 0);
+  Serial.print(" ns/op\t");
+#ifdef HT1632_STATS
+  Serial.print((HT1632.getStats().wireBits - startBits) / (float)calls, 1);
+  Serial.println(" bits/op");
+#else
+  Serial.println("- bits/op");
+#endif
+}
+
+void bench_text(const char * name, const char font [], const char font_width [], char font_height, int font_glyph_step) {
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.drawText(text, n % 4, 0, font, font_width, font_height, font_glyph_step);
+  end_op(name, ITERATIONS);
+}
+
+void setup () {
+  Serial.begin(9600);
+  HT1632.begin(12, 13, 10, 9);
+
+  Serial.print("HT1632 benchmark, OUT_SIZE=");
+  Serial.print(OUT_SIZE);
+  Serial.print(" COM_SIZE=");
+  Serial.print(COM_SIZE);
+#ifdef BICOLOR_MATRIX
+  Serial.print(" NUM_OF_BICOLOR_UNITS=");
+  Serial.print(NUM_OF_BICOLOR_UNITS);
+#endif
+  Serial.println();
+
+  HT1632.drawTarget(BUFFER_BOARD(1));
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    for(int x = 0; x < OUT_SIZE; ++x)
+      HT1632.setPixel(x, n % COM_SIZE, x & 1);
+  end_op("setPixel", ITERATIONS * OUT_SIZE);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.drawImage(IMG_MAIL, IMG_MAIL_WIDTH, IMG_MAIL_HEIGHT, n % 8, 0);
+  end_op("drawImage y%4==0", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.drawImage(IMG_MAIL, IMG_MAIL_WIDTH, IMG_MAIL_HEIGHT, n % 8, 1 + (n % 3));
+  end_op("drawImage y%4!=0", ITERATIONS);
+
+  bench_text("drawText 5x4", FONT_5X4, FONT_5X4_WIDTH, FONT_5X4_HEIGHT, FONT_5X4_STEP_GLYPH);
+  bench_text("drawText 7x5", FONT_7X5, FONT_7X5_WIDTH, FONT_7X5_HEIGHT, FONT_7X5_STEP_GLYPH);
+  bench_text("drawText 8x4", FONT_8X4, FONT_8X4_WIDTH, FONT_8X4_HEIGHT, FONT_8X4_STEP_GLYPH);
+  bench_text("drawText 8x6", FONT_8X6, FONT_8X6_WIDTH, FONT_8X6_HEIGHT, FONT_8X6_STEP_GLYPH);
+  bench_text("drawText 16x8", FONT_16X8, FONT_16X8_WIDTH, FONT_16X8_HEIGHT, FONT_16X8_STEP_GLYPH);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.getTextWidth(text, FONT_5X4_WIDTH, FONT_5X4_HEIGHT);
+  end_op("getTextWidth", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.clear();
+  end_op("clear", ITERATIONS);
+
+  // Full render: clear() flags every word for rewriting.
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n) {
+    HT1632.clear();
+    HT1632.render();
+  }
+  end_op("clear+render full", ITERATIONS);
+
+  // Partial render: one column changes per frame. The display is blank, so the first pass over the
+  //   columns lights them, the second one clears them, and so on.
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n) {
+    HT1632.drawVLine(n % OUT_SIZE, 0, COM_SIZE, (n / OUT_SIZE) % 2 == 0);
+    HT1632.render();
+  }
+  end_op("render 1 column", ITERATIONS);
+
+  // Nothing to send.
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.render();
+  end_op("render idle", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.transition(TRANSITION_BUFFER_SWAP);
+  end_op("transition swap", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.transition(TRANSITION_NONE);
+  end_op("transition none", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.setBrightness(16 - n % 8);
+  end_op("setBrightness", ITERATIONS);
+
+#ifdef HT1632_STATS
+  // Totals for the whole run.
+  Serial.println();
+  HT1632.writeStats();
+#endif
+}
+
+void loop () {
+}
@@ -0,0 +1,37 @@
+/*
+ * Shows frames streamed by a host over Serial, for instance with
+ * "Utilities/Serial streaming/ht1632_stream.py". Each packet is decoded
+ * straight into the board buffer and rendered, and answered with
+ * STREAM_ACK or STREAM_NAK so the host can pace itself.
+ */
+#include <HT1632.h>
+#include <HT1632Receiver.h>
+
+// A packet that stops arriving for this long is dropped.
+#define PACKET_TIMEOUT 100
+
+HT1632Receiver receiver;
+unsigned long lastByte;
+
+void setup () {
+  Serial.begin(115200);
+  HT1632.begin(12, 13, 10, 9);
+}
+
+void loop () {
+  if(!Serial.available()) {
+    if(millis() - lastByte > PACKET_TIMEOUT)
+      receiver.reset();
+    return;
+  }
+  lastByte = millis();
+
+  switch(receiver.feed(Serial.read())) {
+    case STREAM_DONE:
+      Serial.write(STREAM_ACK);
+      break;
+    case STREAM_ERROR:
+      Serial.write(STREAM_NAK);
+      break;
+  }
+}
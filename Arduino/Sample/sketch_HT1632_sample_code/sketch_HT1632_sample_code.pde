@@ -1,9 +1,11 @@
 #include <font_5x4.h>
 #include <HT1632.h>
+#include <HT1632FrameRate.h>
 #include <images.h>
 
 int i = 0;
 int wd;
+HT1632FrameScheduler frames(5);
 
 void setup () {
   Serial.begin(9600);
@@ -53,6 +55,9 @@ void setup () {
 }
 
 void loop () {
+  // Wait for the next frame (5 per second). If drawing took too long, steps tells how many frames
+  //   were merged, so the text keeps scrolling at the same speed.
+  unsigned int steps = frames.waitForFrame();
   
   // Font rendering example
   
@@ -71,7 +76,7 @@ void loop () {
   HT1632.render();
   
   
-  i = (i+1)%(wd + OUT_SIZE * 2);
+  i = (i+steps)%(wd + OUT_SIZE * 2);
   //*/
   
   /*
@@ -94,6 +99,4 @@ void loop () {
   HT1632.drawImage(IMG_MUSICNOTE, IMG_MUSICNOTE_WIDTH,  IMG_MUSICNOTE_HEIGHT, 12, i);
   HT1632.drawImage(IMG_MUSICNOTE, IMG_MUSICNOTE_WIDTH,  IMG_MUSICNOTE_HEIGHT, 18, -i);
   //*/
-  
-  delay(200);
 }
@@ -0,0 +1,151 @@
+#include "HT1632Chains.h"
+#include "HT1632Frame.h"
+
+#include <sched.h>
+
+// pending holds the index of a frame, and this flag while the render thread has not taken it.
+#define CHAIN_FRESH 0x04
+#define CHAIN_INDEX 0x03
+
+#ifdef BICOLOR_MATRIX
+#define CHAIN_BOARDS NUM_COLORS
+#else // BICOLOR_MATRIX
+#define CHAIN_BOARDS 1
+#endif // BICOLOR_MATRIX
+
+HT1632Chains::HT1632Chains() {
+  _numChains = 0;
+  _numThreads = 0;
+  _running = false;
+}
+
+HT1632Chains::~HT1632Chains() {
+  stop();
+  for(int i = 0; i < _numChains; ++i) {
+    delete _chains[i]->display;
+    delete _chains[i];
+  }
+}
+
+#ifdef BICOLOR_MATRIX
+int HT1632Chains::addChain(int pinCS, int pinWR, int pinDATA, int pinCLK, int cpu) {
+#else // BICOLOR_MATRIX
+int HT1632Chains::addChain(int pinCS, int pinWR, int pinDATA, int cpu) {
+  const int pinCLK = -1;
+#endif // BICOLOR_MATRIX
+  if(_running || _numChains >= MAX_CHAINS)
+    return -1;
+
+  Chain * c = new Chain();
+  c->pinCS = pinCS;
+  c->pinWR = pinWR;
+  c->pinDATA = pinDATA;
+  c->pinCLK = pinCLK;
+  c->cpu = cpu;
+  c->back = 0;
+  c->front = 1;
+  c->pending = 2;
+  c->owner = this;
+  _chains[_numChains] = c;
+  return _numChains++;
+}
+
+bool HT1632Chains::start() {
+  if(_running)
+    return false;
+
+  // begin() configures the pins with read-modify-write accesses to shared GPIO registers, so all
+  //   chains are initialized from this thread before any render thread starts.
+  for(int i = 0; i < _numChains; ++i) {
+    Chain & c = *_chains[i];
+    // Value-initialized, like the global HT1632. A previous start() may have left one.
+    delete c.display;
+    c.display = new HT1632Class();
+#ifdef BICOLOR_MATRIX
+    c.display->begin(c.pinCS, c.pinWR, c.pinDATA, c.pinCLK);
+#else // BICOLOR_MATRIX
+    c.display->begin(c.pinCS, c.pinWR, c.pinDATA);
+#endif // BICOLOR_MATRIX
+  }
+
+  _running = true;
+  for(int i = 0; i < _numChains; ++i) {
+    Chain & c = *_chains[i];
+    sem_init(&c.wake, 0, 0);
+    if(pthread_create(&c.thread, NULL, worker, &c) != 0) {
+      sem_destroy(&c.wake);
+      stop(); // Stop the threads that did start.
+      return false;
+    }
+    ++_numThreads;
+    if(c.cpu >= 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(c.cpu, &cpus);
+      pthread_setaffinity_np(c.thread, sizeof(cpus), &cpus);
+    }
+  }
+  return true;
+}
+
+void HT1632Chains::stop() {
+  if(!_running)
+    return;
+  __atomic_store_n(&_running, false, __ATOMIC_RELEASE);
+  for(int i = 0; i < _numThreads; ++i) {
+    sem_post(&_chains[i]->wake);
+    pthread_join(_chains[i]->thread, NULL);
+    sem_destroy(&_chains[i]->wake);
+  }
+  _numThreads = 0;
+}
+
+int HT1632Chains::getNumChains() {
+  return _numChains;
+}
+
+uint8_t * HT1632Chains::frame(int chain) {
+  Chain & c = *_chains[chain];
+  return c.frames[c.back];
+}
+
+void HT1632Chains::present(int chain) {
+  Chain & c = *_chains[chain];
+  // Publish the back frame, and take back whichever frame the render thread is not using.
+  const int previous = __atomic_exchange_n(&c.pending, c.back | CHAIN_FRESH, __ATOMIC_ACQ_REL);
+  if(previous & CHAIN_FRESH)
+    __atomic_add_fetch(&c.dropped, 1, __ATOMIC_RELAXED);
+  c.back = previous & CHAIN_INDEX;
+  sem_post(&c.wake);
+}
+
+unsigned long HT1632Chains::getRenderedFrames(int chain) {
+  return __atomic_load_n(&_chains[chain]->rendered, __ATOMIC_RELAXED);
+}
+
+unsigned long HT1632Chains::getDroppedFrames(int chain) {
+  return __atomic_load_n(&_chains[chain]->dropped, __ATOMIC_RELAXED);
+}
+
+void * HT1632Chains::worker(void * arg) {
+  Chain & c = *(Chain *)arg;
+  for(;;) {
+    sem_wait(&c.wake);
+    if(!__atomic_load_n(&c.owner->_running, __ATOMIC_ACQUIRE))
+      break;
+    // Several present() calls may have posted before this thread woke up. Only the first wake-up
+    //   finds a fresh frame, which is the latest one.
+    if(!(__atomic_load_n(&c.pending, __ATOMIC_ACQUIRE) & CHAIN_FRESH))
+      continue;
+    c.front = __atomic_exchange_n(&c.pending, c.front, __ATOMIC_ACQ_REL) & CHAIN_INDEX;
+    c.owner->drawFrame(c, c.frames[c.front]);
+    __atomic_add_fetch(&c.rendered, 1, __ATOMIC_RELAXED);
+  }
+  return NULL;
+}
+
+// Draw and render every board of the chain, see HT1632Frame.h.
+void HT1632Chains::drawFrame(Chain & c, const uint8_t * pixels) {
+  for(char board = 0; board < CHAIN_BOARDS; ++board)
+    renderFrameBoard(*c.display, pixels, board);
+}
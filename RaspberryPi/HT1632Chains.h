@@ -0,0 +1,86 @@
+/*
+  HT1632Chains.h - Drives several independent chains of HT1632 boards in
+  parallel on the Raspberry Pi.
+
+  Each chain has its own GPIOs (CS, WR, DATA and, on bicolor boards, CLK
+  must not be shared with another chain), its own HT1632Class and its own
+  render thread, optionally pinned to a CPU. The application draws a frame
+  for a chain and hands it over with present(), which never blocks: frames
+  are triple-buffered, and the render thread always picks up the latest
+  one. Bit-banging time then scales with the number of cores instead of
+  the number of chains.
+
+  Frames use the same layout as the ht1632d framebuffer: OUT_SIZE x
+  COM_SIZE bytes, row by row, where bit n of a pixel lights it in buffer
+  BUFFER_BOARD(n+1) of the chain (green and red on bicolor boards). They
+  are drawn into the chain with renderFrameBoard() of HT1632Frame.h.
+
+  Build with -DRASPBERRY_PI -I../Arduino/HT1632 and link with -lpthread.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Chains_h
+#define HT1632Chains_h
+
+#include <HT1632.h>
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+
+#define MAX_CHAINS 8
+#define CHAIN_FRAME_SIZE (OUT_SIZE * COM_SIZE)
+
+class HT1632Chains
+{
+  private:
+    struct Chain {
+      HT1632Class * display;
+      int pinCS;
+      int pinWR;
+      int pinDATA;
+      int pinCLK;
+      int cpu;
+      pthread_t thread;
+      sem_t wake;
+      uint8_t frames [3][CHAIN_FRAME_SIZE];
+      int back;               // Drawn by the application
+      int front;              // Rendered by the worker
+      volatile int pending;   // Handed over, with CHAIN_FRESH set until the worker takes it
+      volatile unsigned long rendered;
+      volatile unsigned long dropped;
+      HT1632Chains * owner;
+    };
+    Chain * _chains [MAX_CHAINS];
+    int _numChains;
+    int _numThreads;
+    volatile bool _running;
+    static void * worker(void * arg);
+    void drawFrame(Chain & c, const uint8_t * pixels);
+
+  public:
+    HT1632Chains();
+    ~HT1632Chains();
+#ifdef BICOLOR_MATRIX
+    // Returns the index of the new chain, or -1. cpu is the CPU to pin its render thread to,
+    //   or -1 to let the scheduler decide.
+    int addChain(int pinCS, int pinWR, int pinDATA, int pinCLK, int cpu = -1);
+#else // BICOLOR_MATRIX
+    int addChain(int pinCS, int pinWR, int pinDATA, int cpu = -1);
+#endif // BICOLOR_MATRIX
+    // Initialize every chain and start the render threads. Call wiringPiSetup() first.
+    bool start();
+    void stop();
+    int getNumChains();
+    // The frame to draw into for chain. Its contents are undefined after present().
+    uint8_t * frame(int chain);
+    // Hand the frame over to the render thread of chain, and return immediately. If the previous
+    //   frame was not picked up yet, it is replaced and counted as dropped.
+    void present(int chain);
+    unsigned long getRenderedFrames(int chain);
+    unsigned long getDroppedFrames(int chain);
+};
+
+#else
+//#error "HT1632Chains.h" already defined!
+#endif
@@ -0,0 +1,45 @@
+/*
+  HT1632Frame.h - Draws the frames of ht1632d and HT1632Chains into an
+  HT1632Class.
+
+  A frame is OUT_SIZE x COM_SIZE bytes, row by row, where bit n of a
+  pixel lights it in buffer BUFFER_BOARD(n+1) (green and red on bicolor
+  boards).
+
+  Released into the public domain.
+*/
+#ifndef HT1632Frame_h
+#define HT1632Frame_h
+
+#include <HT1632.h>
+
+#include <stdint.h>
+#include <string.h>
+
+// drawImage() takes a char width, so frames are copied in strips of this many columns.
+#define FRAME_STRIP_WIDTH 32
+#define FRAME_ROWS ((COM_SIZE + 3) / 4)
+
+// Pack bit board of every pixel in the layout of drawImage(), draw it into buffer
+//   BUFFER_BOARD(board + 1) of display, and render it. drawImage() only flags the words that
+//   actually change, so render() sends the difference.
+static inline void renderFrameBoard(HT1632Class & display, const uint8_t * pixels, char board) {
+  char img [FRAME_STRIP_WIDTH * FRAME_ROWS];
+  const uint8_t bit = 1 << board;
+
+  display.drawTarget(BUFFER_BOARD(board + 1));
+  for(int strip = 0; strip < OUT_SIZE; strip += FRAME_STRIP_WIDTH) {
+    const int width = (OUT_SIZE - strip < FRAME_STRIP_WIDTH) ? OUT_SIZE - strip : FRAME_STRIP_WIDTH;
+    memset(img, 0, sizeof(img));
+    for(int x = 0; x < width; ++x)
+      for(int y = 0; y < COM_SIZE; ++y)
+        if(pixels[y * OUT_SIZE + strip + x] & bit)
+          img[x * FRAME_ROWS + y / 4] |= 1 << (y % 4);
+    display.drawImage(img, width, COM_SIZE, strip, 0);
+  }
+  display.render();
+}
+
+#else
+//#error "HT1632Frame.h" already defined!
+#endif
@@ -0,0 +1,86 @@
+/*
+  ht1632_shm.h - Layout of the shared-memory framebuffer read by ht1632d,
+  and helpers for the processes that draw into it.
+
+  The framebuffer is a POSIX shared memory object (/dev/shm/ht1632 by
+  default) holding a header followed by one byte per pixel, row by row.
+  Bit n of a pixel lights it in buffer BUFFER_BOARD(n+1) of the daemon:
+  on bicolor boards bit 0 is green and bit 1 is red. The daemon drives a
+  single single-color board, on its one CS pin, so there only bit 0 is
+  used. The header tells how many bits are in use.
+
+  Producers must wrap their drawing in ht1632_shm_lock() and
+  ht1632_shm_unlock(). The sequence counter is odd while a producer is
+  drawing, and the daemon only picks up frames whose counter is even and
+  did not change while it was copying them.
+
+  Released into the public domain.
+*/
+#ifndef ht1632_shm_h
+#define ht1632_shm_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HT1632_SHM_NAME  "/ht1632"
+#define HT1632_SHM_MAGIC 0x32363148 // "H162"
+
+struct HT1632SharedFrame {
+  uint32_t magic;
+  uint16_t width;
+  uint16_t height;
+  uint16_t boards;          // Number of pixel bits in use
+  uint16_t reserved;
+  volatile uint32_t lock;   // Held by the producer that is drawing
+  volatile uint32_t sequence;
+  uint8_t pixels [];        // width * height bytes
+};
+
+static inline size_t ht1632_shm_size(int width, int height) {
+  return sizeof(struct HT1632SharedFrame) + (size_t)width * height;
+}
+
+// Map the framebuffer created by the daemon. Returns NULL if the daemon is not running.
+static inline struct HT1632SharedFrame * ht1632_shm_open(const char * name) {
+  int fd = shm_open(name ? name : HT1632_SHM_NAME, O_RDWR, 0);
+  if(fd < 0)
+    return NULL;
+
+  struct stat st;
+  void * map = MAP_FAILED;
+  if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(struct HT1632SharedFrame))
+    map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED)
+    return NULL;
+
+  struct HT1632SharedFrame * frame = (struct HT1632SharedFrame *)map;
+  if(frame->magic != HT1632_SHM_MAGIC || (size_t)st.st_size < ht1632_shm_size(frame->width, frame->height)) {
+    munmap(map, st.st_size);
+    return NULL;
+  }
+  return frame;
+}
+
+static inline void ht1632_shm_lock(struct HT1632SharedFrame * frame) {
+  while(__sync_lock_test_and_set(&frame->lock, 1))
+    sched_yield();
+  __sync_fetch_and_add(&frame->sequence, 1); // Odd: frame being drawn
+}
+
+static inline void ht1632_shm_unlock(struct HT1632SharedFrame * frame) {
+  __sync_fetch_and_add(&frame->sequence, 1); // Even: frame complete
+  __sync_lock_release(&frame->lock);
+}
+
+static inline void ht1632_shm_set_pixel(struct HT1632SharedFrame * frame, int x, int y, uint8_t value) {
+  if(x >= 0 && x < frame->width && y >= 0 && y < frame->height)
+    frame->pixels[y * frame->width + x] = value;
+}
+
+#endif // ht1632_shm_h
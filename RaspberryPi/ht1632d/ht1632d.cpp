@@ -0,0 +1,176 @@
+/*
+  ht1632d.cpp - Display daemon for the HT1632 library on the Raspberry Pi.
+
+  Owns the GPIOs and the HT1632 bus, and shows whatever other processes
+  draw into a shared-memory framebuffer (see ht1632_shm.h). The framebuffer
+  is polled at a fixed rate, and each new frame is copied into the library
+  buffers and sent with render(), so only the words that changed go over
+  the bus. Producers never link the library, and several of them can draw
+  into the same framebuffer.
+
+  Build (with the board settings of HT1632.h):
+    g++ -O2 -DRASPBERRY_PI -I../../Arduino/HT1632 -o ht1632d ht1632d.cpp \
+        ../../Arduino/HT1632/HT1632.cpp -lwiringPi -lrt
+  To try it without a display, `make -C Tests test` from the top of the
+  repository runs it on the simulated bus of Tests/sim (see
+  Tests/daemon.cpp).
+
+  Usage: ht1632d [-r frames_per_second] [-n shm_name]
+
+  Released into the public domain.
+*/
+#include <HT1632.h>
+#include "../HT1632Frame.h"
+#include "ht1632_shm.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wiringPi.h>
+
+// Pins, in wiringPi numbering. These match the Arduino sample sketch.
+#ifdef BICOLOR_MATRIX
+#define PIN_CS   12
+#define PIN_WR   13
+#define PIN_DATA 10
+#define PIN_CLK  9
+#define NUM_BOARDS NUM_COLORS
+#else // BICOLOR_MATRIX
+#define PIN_CS1  12
+#define PIN_WR   10
+#define PIN_DATA 9
+#define NUM_BOARDS 1
+#endif // BICOLOR_MATRIX
+
+#define DEFAULT_RATE 30
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) {
+  running = 0;
+}
+
+static struct HT1632SharedFrame * createFrame(const char * name) {
+  const size_t size = ht1632_shm_size(OUT_SIZE, COM_SIZE);
+  int fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+  if(fd < 0) {
+    perror("shm_open");
+    return NULL;
+  }
+  if(ftruncate(fd, size) < 0) {
+    perror("ftruncate");
+    close(fd);
+    return NULL;
+  }
+  void * map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) {
+    perror("mmap");
+    return NULL;
+  }
+
+  struct HT1632SharedFrame * frame = (struct HT1632SharedFrame *)map;
+  // Keep the contents if a previous instance left a framebuffer of the same geometry.
+  if(frame->magic != HT1632_SHM_MAGIC || frame->width != OUT_SIZE || frame->height != COM_SIZE) {
+    memset(map, 0, size);
+    frame->width = OUT_SIZE;
+    frame->height = COM_SIZE;
+    frame->boards = NUM_BOARDS;
+    __sync_synchronize();
+    frame->magic = HT1632_SHM_MAGIC;
+  }
+  frame->lock = 0; // A producer may have died while holding it.
+  if(frame->sequence & 1)
+    ++frame->sequence;
+  return frame;
+}
+
+// Copy a consistent frame out of shared memory. Returns false if there is no new frame, or if a
+//   producer is drawing into it, in which case it is picked up at the next tick.
+static bool readFrame(struct HT1632SharedFrame * frame, uint8_t * pixels, uint32_t * lastSequence) {
+  const uint32_t sequence = frame->sequence;
+  if(sequence == *lastSequence || (sequence & 1))
+    return false;
+  __sync_synchronize();
+  memcpy(pixels, frame->pixels, OUT_SIZE * COM_SIZE);
+  __sync_synchronize();
+  if(frame->sequence != sequence)
+    return false;
+  *lastSequence = sequence;
+  return true;
+}
+
+static void addMicros(struct timespec * t, long us) {
+  t->tv_nsec += us * 1000;
+  while(t->tv_nsec >= 1000000000L) {
+    t->tv_nsec -= 1000000000L;
+    ++t->tv_sec;
+  }
+}
+
+int main(int argc, char ** argv) {
+  const char * name = HT1632_SHM_NAME;
+  int rate = DEFAULT_RATE;
+  int opt;
+  while((opt = getopt(argc, argv, "r:n:")) != -1) {
+    switch(opt) {
+      case 'r': rate = atoi(optarg); break;
+      case 'n': name = optarg;       break;
+      default:
+        fprintf(stderr, "Usage: %s [-r frames_per_second] [-n shm_name]\n", argv[0]);
+        return 1;
+    }
+  }
+  if(rate < 1)
+    rate = 1;
+
+  struct HT1632SharedFrame * frame = createFrame(name);
+  if(!frame)
+    return 1;
+
+  if(wiringPiSetup() < 0) {
+    fprintf(stderr, "wiringPiSetup failed\n");
+    return 1;
+  }
+#ifdef BICOLOR_MATRIX
+  HT1632.begin(PIN_CS, PIN_WR, PIN_DATA, PIN_CLK);
+#else // BICOLOR_MATRIX
+  HT1632.begin(PIN_CS1, PIN_WR, PIN_DATA);
+#endif // BICOLOR_MATRIX
+
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  static uint8_t pixels [OUT_SIZE * COM_SIZE];
+  uint32_t lastSequence = frame->sequence - 2; // Show the current contents right away.
+  const long period = 1000000L / rate;
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while(running) {
+    if(readFrame(frame, pixels, &lastSequence))
+      for(char board = 0; board < NUM_BOARDS; ++board)
+        renderFrameBoard(HT1632, pixels, board);
+
+    addMicros(&next, period);
+    // If a render overran the period, restart the schedule instead of rushing to catch up.
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if(now.tv_sec > next.tv_sec || (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec))
+      next = now;
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR && running)
+      ;
+  }
+
+  // Leave the display blank, but keep the framebuffer for the next instance.
+  for(char board = 0; board < NUM_BOARDS; ++board) {
+    HT1632.drawTarget(BUFFER_BOARD(board + 1));
+    HT1632.clear();
+    HT1632.render();
+  }
+  munmap(frame, ht1632_shm_size(OUT_SIZE, COM_SIZE));
+  return 0;
+}
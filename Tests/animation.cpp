@@ -0,0 +1,121 @@
+/*
+  animation.cpp - Checks the limits of HT1632Animation, on the simulated
+  bus. Build it with NUM_OF_BICOLOR_UNITS of 4 or more, so that the
+  display is at least 128 pixels wide.
+
+  A 127x8 animation, the widest one drawImage() can draw, must play its
+  full and delta frames in place; a 128x8 one must be rejected by play();
+  and an animation of more than 127 frames must play every frame.
+
+  Released into the public domain.
+*/
+#include "HT1632.h"
+#include "HT1632Animation.h"
+#include "HT1632Sim.h"
+#include <wiringPi.h>
+
+#include <stdio.h>
+#include <vector>
+
+#define HEIGHT 8
+#define ROWS ((HEIGHT + 3) / 4)
+
+static int failures;
+
+static void fail(const char * name, const char * message) {
+  fprintf(stderr, "%s: %s\n", name, message);
+  ++failures;
+}
+
+// Word of the full frame at (column, row).
+static char word(int column, int row) {
+  return (column * 7 + row * 3) & 0b1111;
+}
+
+// An animation width pixels wide: a full frame, then a delta frame that flips two words, one of
+//   them in the last column.
+static std::vector<char> makeAnimation(int width) {
+  const char header [] = { (char)width, HEIGHT, 2, 0 };
+  std::vector<char> anim(header, header + ANIM_HEADER_LEN);
+  const char full [] = { ANIM_FRAME_FULL, ANIM_DURATION(0) };
+  anim.insert(anim.end(), full, full + 3);
+  for(int column = 0; column < width; ++column)
+    for(int row = 0; row < ROWS; ++row)
+      anim.push_back(word(column, row));
+  const char delta [] = { ANIM_FRAME_DELTA, ANIM_DURATION(0), 2,
+                          (char)(3 * ROWS + 1), 0b1111,
+                          (char)((width - 1) * ROWS), 0b0101 };
+  anim.insert(anim.end(), delta, delta + sizeof(delta));
+  return anim;
+}
+
+// Whether the display shows the full frame at (0, 0), with each {column, row, bits} of flipped
+//   XORed into its word.
+static bool shows(int width, const int flipped [][3], int numFlipped) {
+  for(int column = 0; column < width; ++column)
+    for(int row = 0; row < ROWS; ++row) {
+      char expected = word(column, row);
+      for(int k = 0; k < numFlipped; ++k)
+        if(flipped[k][0] == column && flipped[k][1] == row)
+          expected ^= flipped[k][2];
+      for(int bit = 0; bit < 4; ++bit)
+        if(HT1632.getPixel(column, 4 * row + bit) != ((expected >> bit) & 1))
+          return false;
+    }
+  return true;
+}
+
+int main() {
+  wiringPiSetup();
+  simBeginShiftRegister(12, 9, 13, 10, NUM_ACTIVE_CHIPS);
+  HT1632.begin(12, 13, 10, 9);
+  HT1632.drawTarget(BUFFER_BOARD(1));
+  HT1632Animation player;
+
+  // The widest animation: both frames are drawn in place.
+  const int width = ANIM_MAX_SIZE;
+  std::vector<char> wide = makeAnimation(width);
+  HT1632.clear();
+  if(!player.play(&wide[0], 0, 0, false))
+    fail("127x8", "play() rejected the animation");
+  else {
+    player.update();
+    if(!shows(width, NULL, 0))
+      fail("127x8", "the full frame is wrong");
+    player.update();
+    const int flipped [][3] = { {3, 1, 0b1111}, {width - 1, 0, 0b0101} };
+    if(!shows(width, flipped, 2))
+      fail("127x8", "the delta frame is wrong");
+    if(player.isPlaying())
+      fail("127x8", "the animation did not end");
+  }
+
+  // One column more does not fit the width parameter of drawImage().
+  std::vector<char> tooWide = makeAnimation(width + 1);
+  if(player.play(&tooWide[0], 0, 0, false))
+    fail("128x8", "play() accepted the animation");
+
+  // 200 one-word frames.
+  const int frames = 200;
+  std::vector<char> longAnim;
+  const char header [] = { 1, 4, (char)frames, 0 };
+  longAnim.insert(longAnim.end(), header, header + ANIM_HEADER_LEN);
+  for(int f = 0; f < frames; ++f) {
+    const char frame [] = { ANIM_FRAME_FULL, ANIM_DURATION(0), (char)(f & 0b1111) };
+    longAnim.insert(longAnim.end(), frame, frame + sizeof(frame));
+  }
+  int shown = 0;
+  if(!player.play(&longAnim[0], 0, 0, false))
+    fail("200 frames", "play() rejected the animation");
+  while(player.isPlaying() && shown <= frames)
+    shown += player.update();
+  if(shown != frames)
+    fail("200 frames", "the animation did not play every frame exactly once");
+
+  if(failures) {
+    fprintf(stderr, "animation: %d failures\n", failures);
+    return 1;
+  }
+  printf("animation: ok\n");
+  return 0;
+}
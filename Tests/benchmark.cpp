@@ -0,0 +1,154 @@
+/*
+  benchmark.cpp - Microbenchmarks for the drawing and render paths of the
+  HT1632 library, on the simulated bus. Prints, for every operation, the
+  CPU time per call and the number of bits clocked into the chips per call
+  (rising edges of WR seen by the simulated chips), and the number of
+  grayscale planes per second the bus sustains.
+
+  The CPU time includes the simulated bus, so only compare it between runs
+  on the same computer; the bit counts are exact. `make benchmark` builds
+  and runs it for several values of NUM_OF_BICOLOR_UNITS.
+
+  Released into the public domain.
+*/
+#include "HT1632.h"
+#include "font_5x4.h"
+#include "font_7x5.h"
+#include "font_8x4.h"
+#include "font_8x6.h"
+#include "font_16x8.h"
+#include "images.h"
+#include "HT1632Sim.h"
+#include <wiringPi.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#define ITERATIONS 200
+
+static const char text [] = "Hello, how are you?";
+
+static struct timespec startTime;
+static unsigned long startBits;
+
+static void begin_op() {
+  startBits = simWireBits();
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+}
+
+// Prints and returns the CPU time per call, in ns.
+static double end_op(const char * name, long calls) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  const double elapsed = (now.tv_sec - startTime.tv_sec) * 1e9 + (now.tv_nsec - startTime.tv_nsec);
+  printf("%-20s %10.0f ns/op %10.1f bits/op\n", name, elapsed / calls,
+         (double)(simWireBits() - startBits) / calls);
+  return elapsed / calls;
+}
+
+static void bench_text(const char * name, const char font [], const char font_width [], char font_height, int font_glyph_step) {
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.drawText(text, n % 4, 0, font, font_width, font_height, font_glyph_step);
+  end_op(name, ITERATIONS);
+}
+
+int main() {
+  wiringPiSetup();
+#ifdef BICOLOR_MATRIX
+  simBeginShiftRegister(12, 9, 13, 10, NUM_ACTIVE_CHIPS);
+  HT1632.begin(12, 13, 10, 9);
+  printf("HT1632 benchmark, OUT_SIZE=%d COM_SIZE=%d NUM_OF_BICOLOR_UNITS=%d\n", OUT_SIZE, COM_SIZE, NUM_OF_BICOLOR_UNITS);
+#else // BICOLOR_MATRIX
+  const int pinsCS [] = {2, 3, 4, 5};
+  simBeginPins(pinsCS, MAX_CS_PINS, 13, 10);
+  HT1632.begin(pinsCS, MAX_CS_PINS, 13, 10);
+  printf("HT1632 benchmark, OUT_SIZE=%d COM_SIZE=%d MAX_CS_PINS=%d\n", OUT_SIZE, COM_SIZE, MAX_CS_PINS);
+#endif // BICOLOR_MATRIX
+
+  HT1632.drawTarget(BUFFER_BOARD(1));
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    for(int x = 0; x < OUT_SIZE; ++x)
+      HT1632.setPixel(x, n % COM_SIZE, x & 1);
+  end_op("setPixel", (long)ITERATIONS * OUT_SIZE);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.drawImage(IMG_MAIL, IMG_MAIL_WIDTH, IMG_MAIL_HEIGHT, n % 8, 0);
+  end_op("drawImage y%4==0", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.drawImage(IMG_MAIL, IMG_MAIL_WIDTH, IMG_MAIL_HEIGHT, n % 8, 1 + (n % 3));
+  end_op("drawImage y%4!=0", ITERATIONS);
+
+  bench_text("drawText 5x4", FONT_5X4, FONT_5X4_WIDTH, FONT_5X4_HEIGHT, FONT_5X4_STEP_GLYPH);
+  bench_text("drawText 7x5", FONT_7X5, FONT_7X5_WIDTH, FONT_7X5_HEIGHT, FONT_7X5_STEP_GLYPH);
+  bench_text("drawText 8x4", FONT_8X4, FONT_8X4_WIDTH, FONT_8X4_HEIGHT, FONT_8X4_STEP_GLYPH);
+  bench_text("drawText 8x6", FONT_8X6, FONT_8X6_WIDTH, FONT_8X6_HEIGHT, FONT_8X6_STEP_GLYPH);
+  bench_text("drawText 16x8", FONT_16X8, FONT_16X8_WIDTH, FONT_16X8_HEIGHT, FONT_16X8_STEP_GLYPH);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.getTextWidth(text, FONT_5X4_WIDTH, FONT_5X4_HEIGHT);
+  end_op("getTextWidth", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.clear();
+  end_op("clear", ITERATIONS);
+
+  // Full render: clear() flags every word for rewriting.
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n) {
+    HT1632.clear();
+    HT1632.render();
+  }
+  end_op("clear+render full", ITERATIONS);
+
+  // Partial render: one column changes per frame. The display is blank, so the first pass over the
+  //   columns lights them, the second one clears them, and so on.
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n) {
+    HT1632.drawVLine(n % OUT_SIZE, 0, COM_SIZE, (n / OUT_SIZE) % 2 == 0);
+    HT1632.render();
+  }
+  end_op("render 1 column", ITERATIONS);
+
+  // Nothing to send.
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.render();
+  end_op("render idle", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.transition(TRANSITION_BUFFER_SWAP);
+  end_op("transition swap", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.transition(TRANSITION_NONE);
+  end_op("transition none", ITERATIONS);
+
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.setBrightness(16 - n % 8);
+  end_op("setBrightness", ITERATIONS);
+
+  // Grayscale: with a tick of 0, every call shows the next of 4 planes. The level changes along
+  //   each row, so every plane differs from the previous one in most words.
+  HT1632.beginGrayscale(4, 0);
+  for(int y = 0; y < COM_SIZE; ++y)
+    for(int x = 0; x < OUT_SIZE; ++x)
+      HT1632.setGrayPixel(x, y, (x + y) % 16);
+  begin_op();
+  for(int n = 0; n < ITERATIONS; ++n)
+    HT1632.updateGrayscale();
+  printf("%-20s %10.0f planes/s\n", "grayscale", 1e9 / end_op("grayscale plane", ITERATIONS));
+  HT1632.endGrayscale();
+
+  return 0;
+}
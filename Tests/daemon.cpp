@@ -0,0 +1,141 @@
+/*
+  daemon.cpp - Runs the display daemon of RaspberryPi/ht1632d on the
+  simulated bus, and draws into its framebuffer like a producer would.
+
+  Checks that a frame drawn through ht1632_shm.h ends up in the memory of
+  the simulated chips, that a frame is not shown while a producer holds
+  the lock, and that the daemon blanks the display when it stops.
+
+  Released into the public domain.
+*/
+#define main ht1632d_main
+#include "../RaspberryPi/ht1632d/ht1632d.cpp"
+#undef main
+
+#include "HT1632Sim.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define TIMEOUT_MS 5000
+
+static char shmName [32];
+static int daemonResult;
+
+static void * runDaemon(void *) {
+  char arg0 [] = "ht1632d", arg1 [] = "-r", arg2 [] = "200", arg3 [] = "-n";
+  char * argv [] = { arg0, arg1, arg2, arg3, shmName, NULL };
+  daemonResult = ht1632d_main(5, argv);
+  return NULL;
+}
+
+// Pixel of a test pattern, with one bit per board.
+static uint8_t pattern(int seed, int x, int y) {
+  return ((x + y + seed) % 5 == 0 ? 1 : 0) | ((x * 3 + y + seed) % 7 == 0 ? 2 : 0);
+}
+
+static void drawPattern(struct HT1632SharedFrame * frame, int seed) {
+  for(int y = 0; y < COM_SIZE; ++y)
+    for(int x = 0; x < OUT_SIZE; ++x)
+      ht1632_shm_set_pixel(frame, x, y, pattern(seed, x, y) & ((1 << NUM_BOARDS) - 1));
+}
+
+// Whether the simulated chips show the pattern (seed < 0 for a blank display).
+static bool chipsShow(int seed) {
+  simLock();
+  bool same = true;
+  for(int y = 0; y < COM_SIZE && same; ++y)
+    for(int x = 0; x < OUT_SIZE && same; ++x)
+      for(int board = 0; board < NUM_BOARDS; ++board) {
+#ifdef BICOLOR_MATRIX
+        // The green and red memories of a chip are addresses 0 to 31 and 32 to 63.
+        const int chip = GET_CHIP_FROM_X_Y(x, y);
+        const int addr = GET_ADDR_FROM_X_Y(x, y) - chip * 32 + board * 32;
+#else // BICOLOR_MATRIX
+        const int chip = board;
+        const int addr = GET_ADDR_FROM_X_Y(x, y);
+#endif // BICOLOR_MATRIX
+        const bool lit = (simWord(chip, addr) >> (y % 4)) & 1;
+        const bool expected = seed >= 0 && ((pattern(seed, x, y) >> board) & 1);
+        same = same && lit == expected;
+      }
+  simUnlock();
+  return same;
+}
+
+static bool waitForChips(int seed) {
+  for(int ms = 0; ms < TIMEOUT_MS; ms += 5) {
+    if(chipsShow(seed))
+      return true;
+    usleep(5000);
+  }
+  return false;
+}
+
+static int fail(const char * message) {
+  fprintf(stderr, "daemon: %s\n", message);
+  running = 0;
+  shm_unlink(shmName);
+  return 1;
+}
+
+int main() {
+  snprintf(shmName, sizeof(shmName), "/ht1632-test-%d", (int)getpid());
+  shm_unlink(shmName);
+
+#ifdef BICOLOR_MATRIX
+  simBeginShiftRegister(PIN_CS, PIN_CLK, PIN_WR, PIN_DATA, NUM_ACTIVE_CHIPS);
+#else // BICOLOR_MATRIX
+  const int pinsCS [] = { PIN_CS1 };
+  simBeginPins(pinsCS, 1, PIN_WR, PIN_DATA);
+#endif // BICOLOR_MATRIX
+
+  pthread_t thread;
+  if(pthread_create(&thread, NULL, runDaemon, NULL) != 0)
+    return fail("cannot start the daemon thread");
+
+  struct HT1632SharedFrame * frame = NULL;
+  for(int ms = 0; ms < TIMEOUT_MS && !frame; ms += 5) {
+    usleep(5000);
+    frame = ht1632_shm_open(shmName);
+  }
+  if(!frame)
+    return fail("the daemon did not create the framebuffer");
+  if(frame->width != OUT_SIZE || frame->height != COM_SIZE || frame->boards != NUM_BOARDS)
+    return fail("the framebuffer has the wrong geometry");
+
+  // A frame drawn by a producer is shown.
+  ht1632_shm_lock(frame);
+  drawPattern(frame, 0);
+  ht1632_shm_unlock(frame);
+  if(!waitForChips(0))
+    return fail("the first frame was not shown");
+
+  // Nothing is shown while the producer holds the lock, even after many ticks of the daemon.
+  ht1632_shm_lock(frame);
+  drawPattern(frame, 1);
+  for(int tick = 0; tick < 20; ++tick) {
+    usleep(5000);
+    if(!chipsShow(0)) {
+      ht1632_shm_unlock(frame);
+      return fail("a frame was shown while the producer held the lock");
+    }
+  }
+  ht1632_shm_unlock(frame);
+  if(!waitForChips(1))
+    return fail("the second frame was not shown");
+
+  // The daemon blanks the display when it stops.
+  running = 0;
+  pthread_join(thread, NULL);
+  if(daemonResult != 0)
+    return fail("the daemon failed");
+  if(!chipsShow(-1))
+    return fail("the display was not blanked on exit");
+
+  munmap(frame, ht1632_shm_size(OUT_SIZE, COM_SIZE));
+  shm_unlink(shmName);
+  printf("daemon: ok\n");
+  return 0;
+}
@@ -0,0 +1,256 @@
+/*
+  golden.cpp - Golden snapshots of the drawing and render paths of the
+  HT1632 library, on the simulated bus.
+
+  Draws a fixed set of fixtures (every glyph of every font, fully on-screen
+  at each vertical offset within a word and clipped on every side, the
+  images of images.h at every height, alone and over a lit display, and
+  lines of text) and renders each one. For every fixture it hashes the
+  framebuffer and the transactions decoded from the bus, and counts the
+  bits sent. The simulated chips must hold exactly the framebuffer after
+  each render.
+
+  Usage: golden [--update] golden_file
+  Compares the fixtures with golden_file, or rewrites it with --update.
+  Any difference is a change in what is drawn or in what is sent.
+
+  Released into the public domain.
+*/
+#include "HT1632.h"
+#include "font_5x4.h"
+#include "font_7x5.h"
+#include "font_8x4.h"
+#include "font_8x6.h"
+#include "font_16x8.h"
+#include "images.h"
+#include "HT1632Sim.h"
+#include <wiringPi.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static std::string wire;             // Transactions of the current fixture
+static std::vector<std::string> results;
+static int mismatches;               // Pixels where the chips and the framebuffer differ
+static int overwrites;               // Pixels drawn outside of an image
+
+static unsigned long hash(unsigned long h, unsigned char byte) {
+  return ((h ^ byte) * 16777619UL) & 0xFFFFFFFFUL; // FNV-1a
+}
+
+// Whether the simulated chips show pixel (x, y) of the current draw target.
+static bool chipPixel(int x, int y) {
+#ifdef BICOLOR_MATRIX
+  // The green and red memories of a chip are addresses 0 to 31 and 32 to 63.
+  const int chip = GET_CHIP_FROM_X_Y(x, y);
+  const int addr = GET_ADDR_FROM_X_Y(x, y) - chip * 32;
+  return (simWord(chip, addr) >> (y % 4)) & 1;
+#else // BICOLOR_MATRIX
+  return (simWord(0, GET_ADDR_FROM_X_Y(x, y)) >> (y % 4)) & 1;
+#endif // BICOLOR_MATRIX
+}
+
+// Start a fixture from a blank display. The blank display itself is not part of the fixture.
+static void begin_fixture() {
+  HT1632.fillRect(0, 0, HT1632.getWidth(), HT1632.getHeight(), false);
+  HT1632.render();
+  wire.clear();
+  simSetLog(&wire);
+}
+
+// Render the fixture and record it as one line: name, framebuffer hash, wire hash and bits sent.
+static void end_fixture(const char * name) {
+  const unsigned long startBits = simWireBits();
+  HT1632.render();
+  const unsigned long bits = simWireBits() - startBits;
+  simSetLog(NULL);
+
+  unsigned long pixels = 2166136261UL;
+  for(int y = 0; y < HT1632.getHeight(); ++y)
+    for(int x = 0; x < HT1632.getWidth(); ++x) {
+      const bool lit = HT1632.getPixel(x, y);
+      pixels = hash(pixels, lit);
+      if(lit != chipPixel(x, y)) {
+        if(mismatches++ < 10)
+          fprintf(stderr, "%s: pixel (%d, %d) is %s in the framebuffer but not on the chips\n",
+                  name, x, y, lit ? "lit" : "dark");
+      }
+    }
+
+  unsigned long stream = 2166136261UL;
+  for(size_t i = 0; i < wire.size(); ++i)
+    stream = hash(stream, wire[i]);
+
+  char line [128];
+  snprintf(line, sizeof(line), "%s fb=%08lx wire=%08lx bits=%lu", name, pixels, stream, bits);
+  results.push_back(line);
+}
+
+static void fixture_font(const char * name, const char font [], const char font_width [], char font_height, int font_glyph_step) {
+  const int width = HT1632.getWidth();
+  const int height = HT1632.getHeight();
+  char fixture [64];
+  for(int glyph = 0; glyph < 64; ++glyph) {
+    const char glyph_width = font_width[glyph];
+    const int offset = glyph * font_glyph_step;
+
+    // Fully on-screen, at each row of a word (as far as the font fits).
+    for(int y = 0; y < 4 && y + font_height <= height; ++y) {
+      begin_fixture();
+      HT1632.drawImage(font, glyph_width, font_height, 3, y, offset);
+      snprintf(fixture, sizeof(fixture), "%s %d y=%d", name, glyph, y);
+      end_fixture(fixture);
+    }
+
+    // Clipped by each edge.
+    const int clips [4][2] = {
+      { -2, 0 }, { width - 2, 0 }, { 3, -2 }, { 3, height - font_height + 2 }
+    };
+    for(int k = 0; k < 4; ++k) {
+      begin_fixture();
+      HT1632.drawImage(font, glyph_width, font_height, clips[k][0], clips[k][1], offset);
+      snprintf(fixture, sizeof(fixture), "%s %d x=%d,y=%d", name, glyph, clips[k][0], clips[k][1]);
+      end_fixture(fixture);
+    }
+  }
+}
+
+static void fixture_image(const char * name, const char * img, char img_width, char img_height) {
+  char fixture [64];
+  for(int y = -img_height; y <= HT1632.getHeight(); ++y) {
+    begin_fixture();
+    HT1632.drawImage(img, img_width, img_height, HT1632.getWidth() / 2 - 3, y);
+    snprintf(fixture, sizeof(fixture), "%s y=%d", name, y);
+    end_fixture(fixture);
+  }
+}
+
+// Images drawn with ROP_COPY over a lit display, at every height. Only the pixels of the image
+//   may change: the rows below it, in the last word it covers, must stay lit.
+static void fixture_image_over(const char * name, const char * img, char img_width, char img_height) {
+  const int x = HT1632.getWidth() / 2 - 3;
+  char fixture [64];
+  for(int y = -img_height; y <= HT1632.getHeight(); ++y) {
+    begin_fixture();
+    HT1632.fillRect(0, 0, HT1632.getWidth(), HT1632.getHeight());
+    HT1632.drawImage(img, img_width, img_height, x, y);
+    snprintf(fixture, sizeof(fixture), "%s over y=%d", name, y);
+    for(int py = 0; py < HT1632.getHeight(); ++py)
+      for(int px = 0; px < HT1632.getWidth(); ++px)
+        if((px < x || px >= x + img_width || py < y || py >= y + img_height) && !HT1632.getPixel(px, py)) {
+          if(overwrites++ < 10)
+            fprintf(stderr, "%s: pixel (%d, %d) outside of the image was cleared\n", fixture, px, py);
+        }
+    end_fixture(fixture);
+  }
+}
+
+static void fixture_text(const char * name, const char font [], const char font_width [], char font_height, int font_glyph_step) {
+  static const char text [] = "Hello, how are you? 0123";
+  char fixture [64];
+  for(int x = -3; x <= 3; x += 3) {
+    begin_fixture();
+    HT1632.drawText(text, x, 0, font, font_width, font_height, font_glyph_step);
+    snprintf(fixture, sizeof(fixture), "%s text x=%d", name, x);
+    end_fixture(fixture);
+  }
+}
+
+int main(int argc, char ** argv) {
+  const bool update = argc == 3 && strcmp(argv[1], "--update") == 0;
+  if(argc != 2 && !update) {
+    fprintf(stderr, "Usage: %s [--update] golden_file\n", argv[0]);
+    return 2;
+  }
+  const char * path = argv[argc - 1];
+
+  wiringPiSetup();
+#ifdef BICOLOR_MATRIX
+  simBeginShiftRegister(12, 9, 13, 10, NUM_ACTIVE_CHIPS);
+  HT1632.begin(12, 13, 10, 9);
+#else // BICOLOR_MATRIX
+  const int pinsCS [] = {2};
+  simBeginPins(pinsCS, 1, 13, 10);
+  HT1632.begin(pinsCS[0], 13, 10);
+#endif // BICOLOR_MATRIX
+  HT1632.drawTarget(BUFFER_BOARD(1));
+
+  fixture_image("IMG_MAIL", IMG_MAIL, IMG_MAIL_WIDTH, IMG_MAIL_HEIGHT);
+  fixture_image("IMG_FB", IMG_FB, IMG_FB_WIDTH, IMG_FB_HEIGHT);
+  fixture_image("IMG_PHONE", IMG_PHONE, IMG_PHONE_WIDTH, IMG_PHONE_HEIGHT);
+  fixture_image("IMG_MUSIC", IMG_MUSIC, IMG_MUSIC_WIDTH, IMG_MUSIC_HEIGHT);
+  fixture_image("IMG_MUSICNOTE", IMG_MUSICNOTE, IMG_MUSICNOTE_WIDTH, IMG_MUSICNOTE_HEIGHT);
+  fixture_image("IMG_HEART", IMG_HEART, IMG_HEART_WIDTH, IMG_HEART_HEIGHT);
+  fixture_image("IMG_SPEAKER_A", IMG_SPEAKER_A, IMG_SPEAKER_WIDTH, IMG_SPEAKER_HEIGHT);
+  fixture_image("IMG_SPEAKER_B", IMG_SPEAKER_B, IMG_SPEAKER_WIDTH, IMG_SPEAKER_HEIGHT);
+  fixture_image("IMG_SMILEY", IMG_SMILEY, IMG_SMILEY_WIDTH, IMG_SMILEY_HEIGHT);
+  fixture_image("IMG_WINK", IMG_WINK, IMG_WINK_WIDTH, IMG_WINK_HEIGHT);
+  fixture_image("IMG_BIG_HEART", IMG_BIG_HEART, IMG_BIG_HEART_WIDTH, IMG_BIG_HEART_HEIGHT);
+  fixture_image("IMG_CAT", IMG_CAT, IMG_CAT_WIDTH, IMG_CAT_HEIGHT);
+  fixture_image("IMG_OWLS", IMG_OWLS, IMG_OWLS_WIDTH, IMG_OWLS_HEIGHT);
+
+  fixture_image_over("IMG_MAIL", IMG_MAIL, IMG_MAIL_WIDTH, IMG_MAIL_HEIGHT);
+  fixture_image_over("IMG_MUSICNOTE", IMG_MUSICNOTE, IMG_MUSICNOTE_WIDTH, IMG_MUSICNOTE_HEIGHT);
+  fixture_image_over("IMG_SMILEY", IMG_SMILEY, IMG_SMILEY_WIDTH, IMG_SMILEY_HEIGHT);
+  fixture_image_over("IMG_OWLS", IMG_OWLS, IMG_OWLS_WIDTH, IMG_OWLS_HEIGHT);
+  fixture_image_over("IMG_MAIL_2_ROWS", IMG_MAIL, IMG_MAIL_WIDTH, 2);
+
+  fixture_font("FONT_5X4", FONT_5X4, FONT_5X4_WIDTH, FONT_5X4_HEIGHT, FONT_5X4_STEP_GLYPH);
+  fixture_font("FONT_7X5", FONT_7X5, FONT_7X5_WIDTH, FONT_7X5_HEIGHT, FONT_7X5_STEP_GLYPH);
+  fixture_font("FONT_8X4", FONT_8X4, FONT_8X4_WIDTH, FONT_8X4_HEIGHT, FONT_8X4_STEP_GLYPH);
+  fixture_font("FONT_8X6", FONT_8X6, FONT_8X6_WIDTH, FONT_8X6_HEIGHT, FONT_8X6_STEP_GLYPH);
+  fixture_font("FONT_16X8", FONT_16X8, FONT_16X8_WIDTH, FONT_16X8_HEIGHT, FONT_16X8_STEP_GLYPH);
+
+  fixture_text("FONT_5X4", FONT_5X4, FONT_5X4_WIDTH, FONT_5X4_HEIGHT, FONT_5X4_STEP_GLYPH);
+  fixture_text("FONT_7X5", FONT_7X5, FONT_7X5_WIDTH, FONT_7X5_HEIGHT, FONT_7X5_STEP_GLYPH);
+  fixture_text("FONT_8X4", FONT_8X4, FONT_8X4_WIDTH, FONT_8X4_HEIGHT, FONT_8X4_STEP_GLYPH);
+  fixture_text("FONT_8X6", FONT_8X6, FONT_8X6_WIDTH, FONT_8X6_HEIGHT, FONT_8X6_STEP_GLYPH);
+  fixture_text("FONT_16X8", FONT_16X8, FONT_16X8_WIDTH, FONT_16X8_HEIGHT, FONT_16X8_STEP_GLYPH);
+
+  if(mismatches) {
+    fprintf(stderr, "%d pixels differ between the framebuffer and the chips\n", mismatches);
+    return 1;
+  }
+  if(overwrites) {
+    fprintf(stderr, "%d pixels were drawn outside of an image\n", overwrites);
+    return 1;
+  }
+
+  if(update) {
+    FILE * file = fopen(path, "w");
+    if(!file) {
+      perror(path);
+      return 2;
+    }
+    for(size_t i = 0; i < results.size(); ++i)
+      fprintf(file, "%s\n", results[i].c_str());
+    fclose(file);
+    printf("%s: %d fixtures written\n", path, (int)results.size());
+    return 0;
+  }
+
+  FILE * file = fopen(path, "r");
+  if(!file) {
+    perror(path);
+    return 2;
+  }
+  std::vector<std::string> expected;
+  char line [128];
+  while(fgets(line, sizeof(line), file)) {
+    line[strcspn(line, "\n")] = '\0';
+    expected.push_back(line);
+  }
+  fclose(file);
+
+  int differences = 0;
+  for(size_t i = 0; i < results.size() || i < expected.size(); ++i) {
+    const char * got = (i < results.size()) ? results[i].c_str() : "(none)";
+    const char * want = (i < expected.size()) ? expected[i].c_str() : "(none)";
+    if(strcmp(got, want) != 0 && differences++ < 20)
+      printf("line %d: expected %s\n         got      %s\n", (int)i + 1, want, got);
+  }
+  printf("%s: %d fixtures, %d differ\n", path, (int)results.size(), differences);
+  return differences ? 1 : 0;
+}
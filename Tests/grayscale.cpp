@@ -0,0 +1,86 @@
+/*
+  grayscale.cpp - Checks grayscale mode on single-color boards, on the
+  simulated bus. Build it with -DSINGLE_COLOR_MATRIX.
+
+  setGrayPixel() must clip against the grayscale buffer (one board), even
+  while the tiled draw target, which is larger, is selected, and in every
+  orientation. Each plane shown by updateGrayscale() must end up in the
+  simulated chip.
+
+  Released into the public domain.
+*/
+#include "HT1632.h"
+#include "HT1632Sim.h"
+#include <wiringPi.h>
+
+#include <stdio.h>
+
+#define GRAY_BITS 2
+
+static int failures;
+
+static int level(int x, int y) {
+  return (x + 3 * y) % (1 << GRAY_BITS);
+}
+
+// Show the next plane and check that chip 0 shows bit plane of level() at every pixel.
+static void check_plane(const char * name, int plane) {
+  if(!HT1632.updateGrayscale()) {
+    fprintf(stderr, "%s: no plane was shown\n", name);
+    ++failures;
+    return;
+  }
+  for(int y = 0; y < COM_SIZE; ++y)
+    for(int x = 0; x < OUT_SIZE; ++x) {
+      const bool lit = (simWord(0, GET_ADDR_FROM_X_Y(x, y)) >> (y % 4)) & 1;
+      if(lit != ((level(x, y) >> plane) & 1)) {
+        fprintf(stderr, "%s: pixel (%d, %d) of plane %d is wrong on the chip\n", name, x, y, plane);
+        ++failures;
+        return;
+      }
+    }
+}
+
+int main() {
+  wiringPiSetup();
+  const int pinsCS [] = {2, 3, 4, 5};
+  simBeginPins(pinsCS, MAX_CS_PINS, 13, 10);
+  HT1632.begin(pinsCS, MAX_CS_PINS, 13, 10);
+  HT1632.setTiling(2, 2);
+
+  HT1632.drawTarget(BUFFER_BOARD(1));
+  if(!HT1632.beginGrayscale(GRAY_BITS, 0)) {
+    fprintf(stderr, "grayscale: beginGrayscale() failed\n");
+    return 1;
+  }
+
+  // Every pixel of the tiled target and around it; only those of the first board are kept.
+  HT1632.drawTarget(BUFFER_TILED);
+  for(int y = -4; y < HT1632.getHeight() + 4; ++y)
+    for(int x = -4; x < HT1632.getWidth() + 4; ++x)
+      HT1632.setGrayPixel(x, y, (x >= 0 && x < OUT_SIZE && y >= 0 && y < COM_SIZE) ? level(x, y) : 3);
+  HT1632.drawTarget(BUFFER_BOARD(1));
+  check_plane("tiled", 1);
+  check_plane("tiled", 0);
+
+  // Rotated, the grayscale buffer is COM_SIZE pixels wide and OUT_SIZE pixels high.
+  HT1632.clearGrayscale();
+  HT1632.setOrientation(ROTATE_90);
+  HT1632.drawTarget(BUFFER_TILED);
+  for(int y = -4; y < HT1632.getHeight() + 4; ++y)
+    for(int x = -4; x < HT1632.getWidth() + 4; ++x) {
+      const int phys_x = OUT_SIZE - 1 - y, phys_y = x;
+      HT1632.setGrayPixel(x, y, (x >= 0 && x < COM_SIZE && y >= 0 && y < OUT_SIZE) ? level(phys_x, phys_y) : 3);
+    }
+  HT1632.drawTarget(BUFFER_BOARD(1));
+  check_plane("rotated", 1);
+  check_plane("rotated", 0);
+
+  HT1632.endGrayscale();
+  if(failures) {
+    fprintf(stderr, "grayscale: %d failures\n", failures);
+    return 1;
+  }
+  printf("grayscale: ok\n");
+  return 0;
+}
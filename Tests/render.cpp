@@ -0,0 +1,96 @@
+/*
+  render.cpp - Checks the cost of render() on a long chain of bicolor
+  units, on the simulated bus. Build it with a large NUM_OF_BICOLOR_UNITS.
+
+  Every render must walk the CS shift register at most once (at most
+  NUM_ACTIVE_CHIPS + 1 CLK pulses, including shifting the selection out),
+  open at most one write session per chip, and leave the simulated chips
+  holding exactly the framebuffer.
+
+  Released into the public domain.
+*/
+#include "HT1632.h"
+#include "HT1632Sim.h"
+#include <wiringPi.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static int failures;
+
+// Whether the simulated chips show pixel (x, y) of the current draw target.
+static bool chipPixel(int x, int y) {
+  // The green and red memories of a chip are addresses 0 to 31 and 32 to 63.
+  const int chip = GET_CHIP_FROM_X_Y(x, y);
+  const int addr = GET_ADDR_FROM_X_Y(x, y) - chip * 32;
+  return (simWord(chip, addr) >> (y % 4)) & 1;
+}
+
+// Render, and check the CLK pulses, the sessions and the chips.
+static void check_render(const char * name, unsigned long maxPulses) {
+  std::string wire;
+  simSetLog(&wire);
+  const unsigned long startPulses = simClkPulses();
+  HT1632.render();
+  const unsigned long pulses = simClkPulses() - startPulses;
+  simSetLog(NULL);
+
+  if(pulses > maxPulses) {
+    fprintf(stderr, "%s: %lu CLK pulses, expected at most %lu\n", name, pulses, maxPulses);
+    ++failures;
+  }
+
+  int sessions [NUM_ACTIVE_CHIPS] = {0};
+  int chip;
+  char id;
+  for(const char * line = wire.c_str(); sscanf(line, "%d %c", &chip, &id) == 2; line = strchr(line, '\n') + 1) {
+    if(id == 'W' && ++sessions[chip] == 2) {
+      fprintf(stderr, "%s: more than one write session for chip %d\n", name, chip);
+      ++failures;
+    }
+  }
+
+  for(int y = 0; y < COM_SIZE; ++y)
+    for(int x = 0; x < OUT_SIZE; ++x)
+      if(HT1632.getPixel(x, y) != chipPixel(x, y)) {
+        fprintf(stderr, "%s: pixel (%d, %d) differs between the framebuffer and the chips\n", name, x, y);
+        ++failures;
+        return;
+      }
+}
+
+int main() {
+  wiringPiSetup();
+  simBeginShiftRegister(12, 9, 13, 10, NUM_ACTIVE_CHIPS);
+  HT1632.begin(12, 13, 10, 9);
+  HT1632.drawTarget(BUFFER_BOARD(1));
+  const unsigned long oneWalk = NUM_ACTIVE_CHIPS + 1;
+
+  HT1632.clear();
+  check_render("full", oneWalk);
+
+  // A few columns far apart, each with two pixels in the same chip and clean words between them.
+  for(int x = 3; x < OUT_SIZE; x += OUT_SIZE / 3) {
+    HT1632.setPixel(x, 0, true);
+    HT1632.setPixel(x + 2, 7, true);
+  }
+  check_render("sparse", oneWalk);
+
+  srand(1);
+  for(int frame = 0; frame < 2; ++frame) {
+    for(int n = 0; n < OUT_SIZE; ++n)
+      HT1632.setPixel(rand() % OUT_SIZE, rand() % COM_SIZE, rand() & 1);
+    check_render("random", oneWalk);
+  }
+
+  check_render("idle", 0);
+
+  if(failures) {
+    fprintf(stderr, "render: %d failures\n", failures);
+    return 1;
+  }
+  printf("render: ok, %d chips\n", NUM_ACTIVE_CHIPS);
+  return 0;
+}
@@ -0,0 +1,286 @@
+#include "HT1632Sim.h"
+#include "wiringPi.h"
+
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+
+// HT1632 IDs, see HT1632.h.
+#define SIM_ID_CMD 0b100
+#define SIM_ID_RD  0b110
+#define SIM_ID_WR  0b101
+
+// What a selected chip expects next.
+enum SimState {
+  SIM_ID,      // 3-bit ID
+  SIM_ADDRESS, // 7-bit address, after SIM_ID_WR or SIM_ID_RD
+  SIM_WRITE,   // 4-bit words, least significant bit first
+  SIM_READ,    // Bits going out on RD
+  SIM_COMMAND, // 9-bit commands (8 bits and a don't-care bit)
+  SIM_UNKNOWN  // Unknown ID; everything is ignored until the chip is deselected
+};
+
+struct SimChip {
+  bool selected;
+  char state;
+  char id;
+  int bits;           // Bits received (or sent) of the current field
+  unsigned int value; // Field being received
+  int addr;
+  int count;          // Words read in this selection
+  std::string line;   // Transaction being decoded, for the log
+  unsigned char mem [SIM_CHIP_WORDS];
+};
+
+static std::recursive_mutex simMutex;
+static char simPins [SIM_MAX_PINS];
+static bool simShiftRegister;
+static int simPinCS = -1;
+static int simPinCLK = -1;
+static int simPinWR = -1;
+static int simPinDATA = -1;
+static int simPinRD = -1;
+static int simPinsCS [SIM_MAX_CHIPS];
+static int simNumChips;
+static bool simRegister [SIM_MAX_CHIPS]; // CS shift register, true when HIGH
+static SimChip simChips [SIM_MAX_CHIPS];
+static unsigned long simWR;
+static unsigned long simCLK;
+static unsigned long simTime;
+static std::string * simLog;
+
+static void appendHex(std::string & line, unsigned int value, int digits) {
+  char text [16];
+  snprintf(text, sizeof(text), "%0*X", digits, value);
+  line += text;
+}
+
+// A selection ends: the chip is ready for a new ID, and the transaction goes to the log.
+static void endSelection(int chip) {
+  SimChip & c = simChips[chip];
+  if(c.state == SIM_READ)
+    appendHex(c.line += " ", c.count, 1);
+  if(simLog && !c.line.empty())
+    *simLog += c.line + "\n";
+  c.line.clear();
+  c.state = SIM_ID;
+  c.bits = 0;
+  c.value = 0;
+}
+
+static void setSelected(int chip, bool selected) {
+  if(simChips[chip].selected != selected)
+    endSelection(chip);
+  simChips[chip].selected = selected;
+}
+
+// Rising edge of WR: every selected chip takes the bit on DATA.
+static void clockBit() {
+  ++simWR;
+  const int bit = simPins[simPinDATA] ? 1 : 0;
+  for(int chip = 0; chip < simNumChips; ++chip) {
+    SimChip & c = simChips[chip];
+    if(!c.selected)
+      continue;
+    if(c.line.empty()) {
+      char text [16];
+      snprintf(text, sizeof(text), "%d ", chip);
+      c.line = text;
+    }
+
+    switch(c.state) {
+      case SIM_ID:
+        c.value = (c.value << 1) | bit;
+        if(++c.bits == 3) {
+          c.id = c.value;
+          if(c.id == SIM_ID_WR || c.id == SIM_ID_RD)
+            c.state = SIM_ADDRESS;
+          else if(c.id == SIM_ID_CMD)
+            c.state = SIM_COMMAND;
+          else
+            c.state = SIM_UNKNOWN;
+          c.line += (c.id == SIM_ID_WR) ? "W" : (c.id == SIM_ID_RD) ? "R" : (c.id == SIM_ID_CMD) ? "C" : "?";
+          c.bits = 0;
+          c.value = 0;
+        }
+        break;
+      case SIM_ADDRESS:
+        c.value = (c.value << 1) | bit;
+        if(++c.bits == 7) {
+          c.addr = c.value;
+          c.count = 0;
+          c.state = (c.id == SIM_ID_RD) ? SIM_READ : SIM_WRITE;
+          appendHex(c.line += " ", c.addr, 2);
+          if(c.state == SIM_WRITE)
+            c.line += " ";
+          c.bits = 0;
+          c.value = 0;
+        }
+        break;
+      case SIM_WRITE:
+        c.value |= bit << c.bits;
+        if(++c.bits == 4) {
+          c.mem[c.addr] = c.value;
+          c.addr = (c.addr + 1) % SIM_CHIP_WORDS;
+          appendHex(c.line, c.value, 1);
+          c.bits = 0;
+          c.value = 0;
+        }
+        break;
+      case SIM_COMMAND:
+        c.value = (c.value << 1) | bit;
+        if(++c.bits == 9) {
+          appendHex(c.line += " ", c.value >> 1, 2);
+          c.bits = 0;
+          c.value = 0;
+        }
+        break;
+    }
+  }
+}
+
+// Falling edge of RD: the selected chips in read mode put their next bit on DATA.
+static void readBit() {
+  for(int chip = 0; chip < simNumChips; ++chip) {
+    SimChip & c = simChips[chip];
+    if(!c.selected || c.state != SIM_READ)
+      continue;
+    simPins[simPinDATA] = (c.mem[c.addr] >> c.bits) & 1;
+    if(++c.bits == 4) {
+      c.addr = (c.addr + 1) % SIM_CHIP_WORDS;
+      ++c.count;
+      c.bits = 0;
+    }
+  }
+}
+
+// Rising edge of CLK: the shift register moves by one chip and takes CS as its first bit.
+static void shiftRegister() {
+  ++simCLK;
+  for(int chip = simNumChips - 1; chip > 0; --chip)
+    simRegister[chip] = simRegister[chip - 1];
+  simRegister[0] = simPins[simPinCS];
+  for(int chip = 0; chip < simNumChips; ++chip)
+    setSelected(chip, !simRegister[chip]);
+}
+
+static void begin(int pinWR, int pinDATA, int numChips) {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  simPinWR = pinWR;
+  simPinDATA = pinDATA;
+  simPinRD = -1;
+  simNumChips = (numChips > SIM_MAX_CHIPS) ? SIM_MAX_CHIPS : numChips;
+  for(int chip = 0; chip < SIM_MAX_CHIPS; ++chip) {
+    simRegister[chip] = true;
+    simChips[chip].selected = false;
+    endSelection(chip);
+  }
+  simReset();
+}
+
+void simBeginShiftRegister(int pinCS, int pinCLK, int pinWR, int pinDATA, int numChips) {
+  simShiftRegister = true;
+  simPinCS = pinCS;
+  simPinCLK = pinCLK;
+  begin(pinWR, pinDATA, numChips);
+}
+
+void simBeginPins(const int pinsCS [], int numChips, int pinWR, int pinDATA) {
+  simShiftRegister = false;
+  simPinCS = simPinCLK = -1;
+  for(int chip = 0; chip < numChips && chip < SIM_MAX_CHIPS; ++chip)
+    simPinsCS[chip] = pinsCS[chip];
+  begin(pinWR, pinDATA, numChips);
+}
+
+void simSetReadPin(int pinRD) {
+  simPinRD = pinRD;
+}
+
+void simReset() {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  for(int chip = 0; chip < SIM_MAX_CHIPS; ++chip)
+    memset(simChips[chip].mem, 0, SIM_CHIP_WORDS);
+  simWR = 0;
+  simCLK = 0;
+}
+
+unsigned char simWord(int chip, int addr) {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  return simChips[chip].mem[addr % SIM_CHIP_WORDS];
+}
+
+unsigned long simWireBits() {
+  return simWR;
+}
+
+unsigned long simClkPulses() {
+  return simCLK;
+}
+
+void simSetLog(std::string * log) {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  simLog = log;
+}
+
+void simLock() {
+  simMutex.lock();
+}
+
+void simUnlock() {
+  simMutex.unlock();
+}
+
+/*
+ * wiringPi functions
+ */
+
+int wiringPiSetup(void) {
+  return 0;
+}
+
+void pinMode(int, int) {
+}
+
+void digitalWrite(int pin, int value) {
+  if(pin < 0 || pin >= SIM_MAX_PINS)
+    return;
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  const bool rising = !simPins[pin] && value;
+  const bool falling = simPins[pin] && !value;
+  simPins[pin] = value ? HIGH : LOW;
+
+  if(rising && pin == simPinWR)
+    clockBit();
+  else if(falling && pin == simPinRD)
+    readBit();
+  else if(rising && simShiftRegister && pin == simPinCLK)
+    shiftRegister();
+  else if((rising || falling) && !simShiftRegister)
+    for(int chip = 0; chip < simNumChips; ++chip)
+      if(pin == simPinsCS[chip])
+        setSelected(chip, falling);
+}
+
+int digitalRead(int pin) {
+  if(pin < 0 || pin >= SIM_MAX_PINS)
+    return LOW;
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  return simPins[pin];
+}
+
+unsigned int millis(void) {
+  return simTime / 1000;
+}
+
+unsigned int micros(void) {
+  return ++simTime;
+}
+
+void delay(unsigned int howLong) {
+  simTime += howLong * 1000UL;
+}
+
+void delayMicroseconds(unsigned int howLong) {
+  simTime += howLong;
+}
@@ -0,0 +1,50 @@
+/*
+  HT1632Sim.h - Simulated HT1632 bus, to test and benchmark the library on
+  a computer without a display. The library is built with -DRASPBERRY_PI,
+  and HT1632Sim.cpp provides the wiringPi functions it uses: instead of
+  driving GPIO pins, they decode the signals into the memory of simulated
+  chips, the same way the real chips would.
+
+  Time is simulated as well: micros() advances by one microsecond on every
+  call, and delay() and delayMicroseconds() return right away, after
+  advancing the clock.
+
+  Released into the public domain.
+*/
+#ifndef HT1632Sim_h
+#define HT1632Sim_h
+
+#include <string>
+
+#define SIM_MAX_PINS  64
+#define SIM_MAX_CHIPS 128
+#define SIM_CHIP_WORDS 128 /* 4-bit words of memory of a chip (7-bit addresses) */
+
+// Chips selected by the CS shift register of bicolor boards: pinCS is shifted in on each rising
+//   edge of pinCLK, and a chip is selected while its bit is LOW. The first chip of the register is
+//   chip 0.
+void simBeginShiftRegister(int pinCS, int pinCLK, int pinWR, int pinDATA, int numChips);
+// Chips selected by their own CS pin, LOW to select: chip k is on pinsCS[k].
+void simBeginPins(const int pinsCS [], int numChips, int pinWR, int pinDATA);
+// In read mode, the selected chips put the next bit on DATA on each falling edge of pinRD.
+void simSetReadPin(int pinRD);
+
+// Clear the memory of the chips and the counters.
+void simReset();
+// Word at addr of chip, as last written over the bus.
+unsigned char simWord(int chip, int addr);
+// Rising edges of WR (bits clocked into the chips) and of the shift register clock.
+unsigned long simWireBits();
+unsigned long simClkPulses();
+
+// Append every transaction decoded from the bus to log (NULL to stop), one line per chip and
+//   selection: "<chip> W <address> <words>" for writes, "<chip> C <commands>" for commands and
+//   "<chip> R <address> <count>" for reads, with the address, words and commands in hexadecimal.
+void simSetLog(std::string * log);
+
+// The bus can be driven by one thread and inspected by another, for example to watch a render
+//   thread. Hold the lock while reading the chips from the other thread.
+void simLock();
+void simUnlock();
+
+#endif // HT1632Sim_h
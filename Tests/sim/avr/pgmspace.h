@@ -0,0 +1,13 @@
+/*
+  avr/pgmspace.h - Lets the fonts and images of the HT1632 library, which
+  are stored in program memory on the Arduino, build on a computer.
+
+  Released into the public domain.
+*/
+#ifndef pgmspace_h
+#define pgmspace_h
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+
+#endif // pgmspace_h
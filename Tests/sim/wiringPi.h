@@ -0,0 +1,25 @@
+/*
+  wiringPi.h - The part of the wiringPi API used by the HT1632 library,
+  implemented by the simulated bus of HT1632Sim.cpp. Pins are numbered
+  from 0 to SIM_MAX_PINS - 1.
+
+  Released into the public domain.
+*/
+#ifndef wiringPi_h
+#define wiringPi_h
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+int wiringPiSetup(void);
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+unsigned int millis(void);
+unsigned int micros(void);
+void delay(unsigned int howLong);
+void delayMicroseconds(unsigned int howLong);
+
+#endif // wiringPi_h
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Host side of the HT1632 frame stream (see HT1632Receiver.h).
+
+Encodes frames for a board running sketch_HT1632_receiver, sending a full
+frame first and then only XOR deltas against the previous frame, whichever
+is smaller. Requires pyserial to talk to the board.
+
+Usage: ht1632_stream.py PORT [--width 32] [--height 16] [--baud 115200]
+Runs a small demo (a bouncing bar) on the first buffer.
+
+Released into the public domain.
+"""
+
+import argparse
+import time
+
+STREAM_SYNC = 0xA5
+STREAM_FRAME_FULL = 0x01
+STREAM_FRAME_DELTA = 0x02
+STREAM_ACK = 0x06
+STREAM_NAK = 0x15
+
+
+def words_from_pixels(pixels, width, height):
+    """Convert pixels[y][x] (truthy when lit) to 4-bit words, in the order of drawImage()."""
+    words = []
+    for x in range(width):
+        for row in range(0, height, 4):
+            word = 0
+            for bit in range(4):
+                if pixels[row + bit][x]:
+                    word |= 1 << bit
+            words.append(word)
+    return words
+
+
+def pack(words):
+    """Pack words two per byte, the first one in the high nibble."""
+    if len(words) % 2:
+        words = words + [0]
+    return bytes((words[i] << 4) | words[i + 1] for i in range(0, len(words), 2))
+
+
+def packet(frame_type, buffer, payload):
+    body = bytes([frame_type, buffer, len(payload) & 0xFF, len(payload) >> 8]) + payload
+    checksum = 0
+    for b in body:
+        checksum ^= b
+    return bytes([STREAM_SYNC]) + body + bytes([checksum])
+
+
+def encode_full(buffer, words):
+    return packet(STREAM_FRAME_FULL, buffer, pack(words))
+
+
+def encode_delta(buffer, previous, words):
+    """Runs of (skip, count, packed XOR words) covering every word that changed."""
+    xor = [a ^ b for a, b in zip(previous, words)]
+    payload = bytearray()
+    i = 0
+    n = len(xor)
+    while True:
+        skip = 0
+        while i < n and xor[i] == 0:
+            i += 1
+            skip += 1
+        if i == n:
+            break
+        while skip > 255:
+            payload += bytes([255, 0])
+            skip -= 255
+        # Extend the run over short gaps: two unchanged words cost less than a new run header.
+        end = i
+        last = i
+        while end < n and end - i < 255:
+            if xor[end]:
+                last = end
+            elif end - last > 2:
+                break
+            end += 1
+        run = xor[i:last + 1]
+        payload += bytes([skip, len(run)]) + pack(run)
+        i = last + 1
+    return packet(STREAM_FRAME_DELTA, buffer, bytes(payload))
+
+
+class Streamer(object):
+    """Sends frames to a receiver, keeping track of what each buffer holds."""
+
+    def __init__(self, port, timeout=0.5):
+        self.port = port
+        self.timeout = timeout
+        self.previous = {}
+
+    def send(self, buffer, words):
+        previous = self.previous.get(buffer)
+        data = encode_full(buffer, words)
+        if previous is not None:
+            delta = encode_delta(buffer, previous, words)
+            if len(delta) < len(data):
+                data = delta
+        self.port.write(data)
+        if self.wait_ack():
+            self.previous[buffer] = list(words)
+            return True
+        # The buffer contents are unknown: resend everything next time.
+        self.previous.pop(buffer, None)
+        return False
+
+    def wait_ack(self):
+        deadline = time.time() + self.timeout
+        while time.time() < deadline:
+            reply = self.port.read(1)
+            if reply:
+                return reply[0] == STREAM_ACK
+        return False
+
+
+def demo(args):
+    import serial
+    port = serial.Serial(args.port, args.baud, timeout=0.05)
+    time.sleep(2)  # Most Arduinos reset when the port is opened.
+    streamer = Streamer(port)
+    x, step = 0, 1
+    while True:
+        pixels = [[1 if abs(col - x) < 2 else 0 for col in range(args.width)] for _ in range(args.height)]
+        start = time.time()
+        ok = streamer.send(0, words_from_pixels(pixels, args.width, args.height))
+        print("%s %.1f ms" % ("ok " if ok else "nak", (time.time() - start) * 1000))
+        x += step
+        if x <= 0 or x >= args.width - 1:
+            step = -step
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port")
+    parser.add_argument("--width", type=int, default=32)
+    parser.add_argument("--height", type=int, default=16)
+    parser.add_argument("--baud", type=int, default=115200)
+    demo(parser.parse_args())